@@ -1,5 +1,6 @@
 #include "OMTReceive.h"
 #include "HoldingImage.h"
+#include "../shared/OMTRowCopy.h"
 #include <ffglex/FFGLScopedShaderBinding.h>
 #include <ffglex/FFGLScopedSamplerActivation.h>
 #include <ffglex/FFGLScopedTextureBinding.h>
@@ -162,11 +163,13 @@ OMTReceive::OMTReceive() : CFFGLPlugin(), mRunReceive(false), mSourceVersion(0xF
     SetOptionParamInfo(PARAM_SOURCE, "Source", 1, 0.0f);
     SetParamElementInfo(PARAM_SOURCE, 0, "Scanning...", 0.0f);
     SetParamInfof(PARAM_LOGGING, "Logging", FF_TYPE_BOOLEAN);
+    OMTRowCopy::Acquire();
 }
 
 OMTReceive::~OMTReceive()
 {
     DisconnectSource();
+    OMTRowCopy::Release();
 }
 
 FFResult OMTReceive::InitGL(const FFGLViewportStruct* vp)
@@ -260,36 +263,23 @@ FFResult OMTReceive::ProcessOpenGL(ProcessOpenGLStruct* pGL)
         Connect(addr);
     }
 
-    // Pull latest frame out of the shared buffer with minimal lock time —
-    // swap the pixel vector rather than copying, so we never block the
-    // receive thread for more than a pointer swap.
-    {
-        std::lock_guard<std::mutex> lk(mFrameMutex);
-        if(mFrame.fresh)
-        {
-            mUploadW = mFrame.w;
-            mUploadH = mFrame.h;
-            mUploadPixels.swap(mFrame.pixels); // O(1) - no copy
-            mFrame.fresh = false;
-        }
-    }
-
-    // Upload to GPU outside the lock - receive thread is free to write next frame
-    if(mUploadW && mUploadH && !mUploadPixels.empty())
+    // Pull the latest frame out of the mailbox — the receive thread never
+    // writes into a slot we hold, so we upload straight from it.
+    const Frame* f = mFrames.TryRead();
+    if(f && f->w && f->h && !f->pixels.empty())
     {
         glBindTexture(GL_TEXTURE_2D, mVideoTex);
-        if(mUploadW != mVideoTexW || mUploadH != mVideoTexH) {
+        if(f->w != mVideoTexW || f->h != mVideoTexH) {
             glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8,
-                mUploadW, mUploadH, 0, GL_BGRA, GL_UNSIGNED_BYTE, mUploadPixels.data());
-            mVideoTexW=mUploadW; mVideoTexH=mUploadH;
+                f->w, f->h, 0, GL_BGRA, GL_UNSIGNED_BYTE, f->pixels.data());
+            mVideoTexW=f->w; mVideoTexH=f->h;
             Log("video tex " + std::to_string(mVideoTexW) + "x" + std::to_string(mVideoTexH));
         } else {
             glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0,
-                mUploadW, mUploadH, GL_BGRA, GL_UNSIGNED_BYTE, mUploadPixels.data());
+                f->w, f->h, GL_BGRA, GL_UNSIGNED_BYTE, f->pixels.data());
         }
         glBindTexture(GL_TEXTURE_2D, 0);
         mHasFrame = true;
-        mUploadW = mUploadH = 0;
     }
 
     // Draw — live video once we have a frame, holding image until then
@@ -372,9 +362,6 @@ void OMTReceive::ReceiveThreadFunc(std::string address)
         return;
     }
 
-    // Pre-size the pixel buffer to avoid per-frame allocation after the first frame
-    std::vector<uint8_t> stagingPixels;
-
     bool firstFrame = true;
     while(mRunReceive)
     {
@@ -385,22 +372,16 @@ void OMTReceive::ReceiveThreadFunc(std::string address)
         if(firstFrame) {
             firstFrame = false;
             Log("[RX] first frame " + std::to_string(frame->Width) + "x" + std::to_string(frame->Height));
-            stagingPixels.reserve(frame->DataLength);
         }
 
-        // Copy into staging outside the lock
-        stagingPixels.resize(frame->DataLength);
-        std::memcpy(stagingPixels.data(), frame->Data, frame->DataLength);
-
-        // Swap staging into the shared frame — O(1), hold lock as briefly as possible
-        {
-            std::lock_guard<std::mutex> lk(mFrameMutex);
-            mFrame.w = (uint32_t)frame->Width;
-            mFrame.h = (uint32_t)frame->Height;
-            mFrame.pixels.swap(stagingPixels); // O(1)
-            mFrame.fresh = true;
-        }
-        // stagingPixels now holds the previous (stale) buffer — reused next iteration
+        // Copy straight into the mailbox's back slot and publish — the GL
+        // thread only ever reads the front slot, so no lock is needed
+        Frame& slot = mFrames.WriteSlot();
+        slot.w = (uint32_t)frame->Width;
+        slot.h = (uint32_t)frame->Height;
+        slot.pixels.resize(frame->DataLength);
+        OMTRowCopy::Bytes(slot.pixels.data(), (const uint8_t*)frame->Data, frame->DataLength);
+        mFrames.Publish();
     }
 
     omt_receive_destroy(receiver);
@@ -8,6 +8,7 @@
 #define NOMINMAX
 #endif
 #include <libomt.h>
+#include "../shared/OMTVideoBuffer.h"
 #include <atomic>
 #include <mutex>
 #include <string>
@@ -75,10 +76,6 @@ private:
     uint32_t mVideoTexW=0, mVideoTexH=0;
     bool mReady=false, mHasFrame=false;
 
-    // Staging buffer: frame pixels swapped out of mFrameMutex, uploaded outside lock
-    std::vector<uint8_t> mUploadPixels;
-    uint32_t             mUploadW=0, mUploadH=0;
-
     enum ParamIndex : unsigned int { PARAM_SOURCE=0, PARAM_LOGGING, PARAM_COUNT };
     std::vector<std::string> mAddresses;
     float    mSelected = 0;
@@ -86,7 +83,7 @@ private:
     uint32_t mSourceVersion;
 
     // Per-instance receive — all connection state owned by GL thread,
-    // except mFrame which is shared via mFrameMutex.
+    // except mFrames which hands frames from the receive thread lock-free.
     void Connect(const std::string& address);
     void DisconnectSource();
     void ReceiveThreadFunc(std::string address);
@@ -98,8 +95,6 @@ private:
     struct Frame {
         uint32_t w=0, h=0;
         std::vector<uint8_t> pixels;
-        bool fresh = false;
     };
-    std::mutex mFrameMutex;
-    Frame      mFrame;   // written by receive thread, swapped by GL thread
+    TripleBuffer<Frame> mFrames;   // written by receive thread, read by GL thread
 };
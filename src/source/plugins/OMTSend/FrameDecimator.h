@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+
+// ---------------------------------------------------------------------------
+// FrameDecimator
+//
+// Decides, once per host frame, whether that frame is needed to feed a
+// stream at a lower target rate - e.g. every 4th frame when the host renders
+// 120 fps and we send 30 fps - so frames that would only be overwritten
+// before the send thread gets to them are never read back at all.
+//
+// Works like Bresenham's line algorithm: each host frame adds its share of
+// an output frame (target rate x host frame time) to a phase accumulator,
+// and a frame is taken whenever the phase reaches a whole output frame.
+// Taking the host frame *nearest* each ideal send time (hence the half-step
+// tolerance) spreads the drops evenly, so 120 -> 50 fps alternates 2 and 3
+// rather than bunching.  The host frame time is smoothed so render-time
+// jitter doesn't shift the pattern from one frame to the next.
+//
+// Call from one thread only (the GL thread).
+// ---------------------------------------------------------------------------
+
+class FrameDecimator
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Returns true if the host frame rendered at `now` should be captured
+    // for a stream of `targetFps`.  Always true when the host is no faster
+    // than the target.
+    bool Tick( Clock::time_point now, double targetFps )
+    {
+        const bool   first = !mHavePrev;
+        const double dt    = std::chrono::duration< double >( now - mPrev ).count();
+        mHavePrev = true;
+        mPrev     = now;
+
+        // First frame, or the host stalled / we weren't being called: take
+        // this frame and restart the measurement from here.
+        if( first || dt <= 0.0 || dt > kMaxFrameTime )
+        {
+            mPhase = 0.0;
+            return true;
+        }
+
+        mAvgFrameTime = ( mAvgFrameTime > 0.0 ) ? mAvgFrameTime + kSmoothing * ( dt - mAvgFrameTime )
+                                                : dt;
+
+        const double step = targetFps * mAvgFrameTime;   // output frames per host frame
+        if( targetFps <= 0.0 || step >= 1.0 )
+        {
+            mPhase = 0.0;
+            return true;
+        }
+
+        mPhase += step;
+        if( mPhase + step * 0.5 >= 1.0 )
+        {
+            mPhase -= 1.0;
+            return true;
+        }
+        return false;
+    }
+
+    // Smoothed host frame time in seconds, or 0 until it has been measured.
+    double HostFrameTime() const { return mAvgFrameTime; }
+
+    // Forgets the measured host rate, e.g. after the stream was restarted.
+    void Reset()
+    {
+        mHavePrev     = false;
+        mAvgFrameTime = 0.0;
+        mPhase        = 0.0;
+    }
+
+private:
+    static constexpr double kMaxFrameTime = 0.25;   // seconds; longer counts as a stall
+    static constexpr double kSmoothing    = 0.05;   // EMA weight of the newest frame time
+
+    bool              mHavePrev     = false;
+    Clock::time_point mPrev         = {};
+    double            mAvgFrameTime = 0.0;          // seconds, smoothed
+    double            mPhase        = 0.0;          // output frames accumulated
+};
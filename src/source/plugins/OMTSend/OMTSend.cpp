@@ -1,10 +1,15 @@
 #include "OMTSend.h"
+#include "../shared/OMTAlphaScan.h"
+#include "../shared/OMTFrameHash.h"
+#include "../shared/OMTRowCopy.h"
 #include <ffglex/FFGLScopedShaderBinding.h>
 #include <ffglex/FFGLScopedSamplerActivation.h>
 #include <ffglex/FFGLScopedTextureBinding.h>
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <vector>
 #include <fstream>
@@ -44,6 +49,402 @@ void main()
 }
 )";
 
+// Capture pass: renders the visible Width x Height region of the input into
+// the capture FBO with the rows reversed.  glReadPixels returns FBO row 0
+// first, so the readback arrives top-down and tightly packed - exactly the
+// layout OMT wants - with no per-row work left for the CPU.  A tile reads
+// only its own region of the input, starting at Origin, and a scaled
+// stream (Output Size, the preview) is resampled on the way, Step input
+// pixels per output pixel, with the selected filter.
+//
+// For the YUV formats each RGBA8 texel of the target carries four bytes of
+// the final OMT frame, so the target is the frame's byte layout viewed as
+// (Stride / 4) x rows and the readback needs no conversion at all:
+//   UYVY  (w/2) x h             : U Y0 V Y1 per pixel pair
+//   UYVA  (w/2) x (h + h/2)     : UYVY, then the 8-bit alpha plane
+//   NV12  (w/4) x (h + h/2)     : Y plane, then interleaved half-height CbCr
+// The 16-bit formats do the same with an RGBA16 target, four 16-bit samples
+// per texel:
+//   P216  (w/4) x 2h            : Y plane, then interleaved full-height CbCr
+//   PA16  (w/4) x 3h            : P216, then the 16-bit alpha plane
+static const char kCaptureVertexShader[] = R"(#version 410 core
+layout(location = 0) in vec4 vPosition;
+void main()
+{
+    gl_Position = vPosition;
+}
+)";
+
+static const char kCaptureFragmentShader[] = R"(#version 410 core
+uniform sampler2D InputTexture;
+uniform vec2 Size;        // output frame size in pixels
+uniform vec2 Origin;      // top-left of the source region in the input
+uniform vec2 Step;        // input pixels per output pixel (1 = no scaling)
+uniform int  Filter;      // OMTSend::ScaleFilter, when scaling
+uniform int  InputHeight; // visible input height, for the flip
+uniform int  Format;      // OMTSend::PixelFormat
+uniform vec2 KrKb;        // luma coefficients of the YCbCr matrix
+out vec4 fragColor;
+
+// Input texel, top-down (row 0 is the top of the image), clamped to the
+// source region so filters never pull in a neighbouring tile
+vec4 Texel( ivec2 p )
+{
+    p = clamp( p, ivec2( Origin ), ivec2( Origin + Size * Step + 0.5 ) - 1 );
+    return texelFetch( InputTexture, ivec2( p.x, InputHeight - 1 - p.y ), 0 );
+}
+
+vec4 Bilinear( vec2 c )
+{
+    vec2  p = c - 0.5;
+    ivec2 i = ivec2( floor( p ) );
+    vec2  f = p - vec2( i );
+    return mix( mix( Texel( i ),               Texel( i + ivec2( 1, 0 ) ), f.x ),
+                mix( Texel( i + ivec2( 0, 1 ) ), Texel( i + ivec2( 1, 1 ) ), f.x ), f.y );
+}
+
+// Catmull-Rom weights of the four taps around a sample at fraction t
+vec4 CubicWeights( float t )
+{
+    float t2 = t * t, t3 = t2 * t;
+    return vec4( -0.5 * t3 +       t2 - 0.5 * t,
+                  1.5 * t3 - 2.5 * t2 + 1.0,
+                 -1.5 * t3 + 2.0 * t2 + 0.5 * t,
+                  0.5 * t3 - 0.5 * t2 );
+}
+
+vec4 Bicubic( vec2 c )
+{
+    vec2  p  = c - 0.5;
+    ivec2 i  = ivec2( floor( p ) );
+    vec2  f  = p - vec2( i );
+    vec4  wx = CubicWeights( f.x ), wy = CubicWeights( f.y );
+    vec4  sum = vec4( 0.0 );
+    for( int j = 0; j < 4; ++j )
+    {
+        vec4 row = vec4( 0.0 );
+        for( int k = 0; k < 4; ++k )
+            row += wx[ k ] * Texel( i + ivec2( k - 1, j - 1 ) );
+        sum += wy[ j ] * row;
+    }
+    return clamp( sum, 0.0, 1.0 );   // the negative lobes overshoot at edges
+}
+
+// Exact area average: every input texel under the output pixel, weighted
+// by how much of it is covered
+vec4 Area( vec2 p0 )
+{
+    vec2  p1  = p0 + Step;
+    ivec2 i0  = ivec2( floor( p0 ) ), i1 = ivec2( ceil( p1 ) );
+    vec4  sum = vec4( 0.0 );
+    for( int y = i0.y; y < i1.y; ++y )
+    {
+        float wy = min( p1.y, float( y + 1 ) ) - max( p0.y, float( y ) );
+        for( int x = i0.x; x < i1.x; ++x )
+            sum += wy * ( min( p1.x, float( x + 1 ) ) - max( p0.x, float( x ) ) ) * Texel( ivec2( x, y ) );
+    }
+    return sum / ( Step.x * Step.y );
+}
+
+// Output pixel (x, y), top-down
+vec4 Pixel( int x, int y )
+{
+    if( Step == vec2( 1.0 ) )
+        return Texel( ivec2( Origin ) + ivec2( x, y ) );
+
+    vec2 p = Origin + vec2( x, y ) * Step;
+    if( Filter == 0 ) return Bilinear( p + 0.5 * Step );
+    if( Filter == 1 ) return Bicubic( p + 0.5 * Step );
+    return Area( p );
+}
+
+// Video-range Y'CbCr, scaled to 0..1 for an 8-bit unorm target
+vec3 ToYCbCr( vec3 rgb )
+{
+    float y  = dot( rgb, vec3( KrKb.x, 1.0 - KrKb.x - KrKb.y, KrKb.y ) );
+    float cb = ( rgb.b - y ) / ( 2.0 * ( 1.0 - KrKb.y ) );
+    float cr = ( rgb.r - y ) / ( 2.0 * ( 1.0 - KrKb.x ) );
+    return vec3( 16.0 + 219.0 * y, 128.0 + 224.0 * cb, 128.0 + 224.0 * cr ) / 255.0;
+}
+
+// The same, scaled for a 16-bit unorm target (16 << 8 .. 235 << 8)
+vec3 ToYCbCr16( vec3 rgb )
+{
+    return ToYCbCr( rgb ) * ( 65280.0 / 65535.0 );
+}
+
+// Alpha of the i-th pixel in raster order (for the packed UYVA alpha plane)
+float AlphaAt( int i )
+{
+    int w = int( Size.x );
+    return ( i < w * int( Size.y ) ) ? Pixel( i % w, i / w ).a : 0.0;
+}
+
+void main()
+{
+    ivec2 dst = ivec2( gl_FragCoord.xy );
+    int   h   = int( Size.y );
+
+    if( Format == 1 || Format == 2 )        // UYVY / UYVA
+    {
+        if( dst.y < h )
+        {
+            vec3 a = ToYCbCr( Pixel( dst.x * 2,     dst.y ).rgb );
+            vec3 b = ToYCbCr( Pixel( dst.x * 2 + 1, dst.y ).rgb );
+            fragColor = vec4( ( a.y + b.y ) * 0.5, a.x, ( a.z + b.z ) * 0.5, b.x );
+        }
+        else
+        {
+            int i = ( ( dst.y - h ) * ( int( Size.x ) / 2 ) + dst.x ) * 4;
+            fragColor = vec4( AlphaAt( i ), AlphaAt( i + 1 ), AlphaAt( i + 2 ), AlphaAt( i + 3 ) );
+        }
+    }
+    else if( Format == 3 )                  // NV12
+    {
+        int x = dst.x * 4;
+        if( dst.y < h )
+        {
+            fragColor = vec4( ToYCbCr( Pixel( x,     dst.y ).rgb ).x,
+                              ToYCbCr( Pixel( x + 1, dst.y ).rgb ).x,
+                              ToYCbCr( Pixel( x + 2, dst.y ).rgb ).x,
+                              ToYCbCr( Pixel( x + 3, dst.y ).rgb ).x );
+        }
+        else
+        {
+            int  y  = ( dst.y - h ) * 2;
+            vec3 c0 = ToYCbCr( 0.25 * ( Pixel( x,     y ) + Pixel( x + 1, y ) +
+                                        Pixel( x,     y + 1 ) + Pixel( x + 1, y + 1 ) ).rgb );
+            vec3 c1 = ToYCbCr( 0.25 * ( Pixel( x + 2, y ) + Pixel( x + 3, y ) +
+                                        Pixel( x + 2, y + 1 ) + Pixel( x + 3, y + 1 ) ).rgb );
+            fragColor = vec4( c0.y, c0.z, c1.y, c1.z );
+        }
+    }
+    else if( Format == 4 || Format == 5 )   // P216 / PA16
+    {
+        int x = dst.x * 4;
+        if( dst.y < h )
+        {
+            fragColor = vec4( ToYCbCr16( Pixel( x,     dst.y ).rgb ).x,
+                              ToYCbCr16( Pixel( x + 1, dst.y ).rgb ).x,
+                              ToYCbCr16( Pixel( x + 2, dst.y ).rgb ).x,
+                              ToYCbCr16( Pixel( x + 3, dst.y ).rgb ).x );
+        }
+        else if( dst.y < 2 * h )
+        {
+            int  y  = dst.y - h;
+            vec3 c0 = ToYCbCr16( 0.5 * ( Pixel( x,     y ) + Pixel( x + 1, y ) ).rgb );
+            vec3 c1 = ToYCbCr16( 0.5 * ( Pixel( x + 2, y ) + Pixel( x + 3, y ) ).rgb );
+            fragColor = vec4( c0.y, c0.z, c1.y, c1.z );
+        }
+        else
+        {
+            int y = dst.y - 2 * h;
+            fragColor = vec4( Pixel( x,     y ).a, Pixel( x + 1, y ).a,
+                              Pixel( x + 2, y ).a, Pixel( x + 3, y ).a );
+        }
+    }
+    else                                    // BGRA (swizzled by the readback)
+    {
+        fragColor = Pixel( dst.x, dst.y );
+    }
+}
+)";
+
+// Works out how a w x h frame is laid out for the requested pixel format.
+// Falls back to BGRA when the dimensions can't be subsampled cleanly.
+static OMTSend::PackLayout ChoosePackLayout( OMTSend::PixelFormat format, uint32_t w, uint32_t h )
+{
+    OMTSend::PackLayout l = {};
+
+    // Same rule libomt applies for OMTColorSpace_Undefined
+    l.colorSpace = ( h < 720 ) ? OMTColorSpace_BT601 : OMTColorSpace_BT709;
+
+    if( ( format == OMTSend::PIXFMT_UYVY || format == OMTSend::PIXFMT_UYVA ) && w % 2 == 0 )
+    {
+        const bool alpha = ( format == OMTSend::PIXFMT_UYVA );
+        l.format       = format;
+        l.codec        = alpha ? OMTCodec_UYVA : OMTCodec_UYVY;
+        l.stride       = w * 2;
+        l.dataBytes    = (size_t)w * h * ( alpha ? 3 : 2 );
+        l.targetW      = w / 2;
+        l.targetH      = alpha ? h + ( h + 1 ) / 2 : h;
+        l.targetFormat = GL_RGBA8;
+        l.readFormat   = GL_RGBA;
+        l.readType     = GL_UNSIGNED_BYTE;
+        l.texelBytes   = 4;
+        return l;
+    }
+    if( format == OMTSend::PIXFMT_NV12 && w % 4 == 0 && h % 2 == 0 )
+    {
+        l.format       = format;
+        l.codec        = OMTCodec_NV12;
+        l.stride       = w;
+        l.dataBytes    = (size_t)w * h * 3 / 2;
+        l.targetW      = w / 4;
+        l.targetH      = h + h / 2;
+        l.targetFormat = GL_RGBA8;
+        l.readFormat   = GL_RGBA;
+        l.readType     = GL_UNSIGNED_BYTE;
+        l.texelBytes   = 4;
+        return l;
+    }
+    if( ( format == OMTSend::PIXFMT_P216 || format == OMTSend::PIXFMT_PA16 ) && w % 4 == 0 )
+    {
+        // Little-endian 16-bit samples, exactly what GL_UNSIGNED_SHORT returns
+        const bool alpha = ( format == OMTSend::PIXFMT_PA16 );
+        l.format       = format;
+        l.codec        = alpha ? OMTCodec_PA16 : OMTCodec_P216;
+        l.stride       = w * 2;
+        l.dataBytes    = (size_t)w * h * ( alpha ? 6 : 4 );
+        l.targetW      = w / 4;
+        l.targetH      = alpha ? h * 3 : h * 2;
+        l.targetFormat = GL_RGBA16;
+        l.readFormat   = GL_RGBA;
+        l.readType     = GL_UNSIGNED_SHORT;
+        l.texelBytes   = 8;
+        return l;
+    }
+
+    l.format       = OMTSend::PIXFMT_BGRA;
+    l.codec        = OMTCodec_BGRA;
+    l.stride       = w * 4;
+    l.dataBytes    = (size_t)w * h * 4;
+    l.targetW      = w;
+    l.targetH      = h;
+    l.targetFormat = GL_RGBA8;
+    l.readFormat   = GL_BGRA;
+    l.readType     = GL_UNSIGNED_BYTE;
+    l.texelBytes   = 4;
+    return l;
+}
+
+// Consecutive opaque frames before the alpha flag is dropped (~0.5 s at 60 fps)
+static const int kOpaqueFramesBeforeNoAlpha = 30;
+
+// Longest a run of duplicate frames goes without one being re-sent, so
+// receivers still see the source is alive
+static const auto kDuplicateKeepAlive = std::chrono::seconds( 1 );
+
+// How often the send thread logs its counters (when logging is enabled)
+static const auto kStatsLogInterval = std::chrono::seconds( 10 );
+
+// Adaptive Quality: how often encoder statistics are sampled, how many
+// consecutive overloaded / relaxed samples halve / double the send rate,
+// the shortest time between changes, and the lowest rate (1 / divisor).
+// libomt can't change the quality of a live sender - only recreate it,
+// which makes receivers reconnect - so encode quality is left to libomt
+// and the receivers' suggestions, and only the send rate is adapted.
+static const auto kQualitySampleInterval    = std::chrono::seconds( 1 );
+static const int  kQualityOverloadedSamples = 3;
+static const int  kQualityRelaxedSamples    = 15;
+static const auto kQualityHoldTime          = std::chrono::seconds( 5 );
+static const int  kMaxRateDivisor           = 4;
+
+// How often a stream whose sender couldn't be created tries again
+static const auto kSenderRetryInterval = std::chrono::seconds( 1 );
+
+// How often an idle send task polls its sender for new receivers: a
+// stream nobody has connected to since sending started waits longest,
+// one whose receivers have left about a frame (see RunSendTask).  With
+// receivers, new frames wake the task and the poll only gathers stats.
+static const auto kPollNeverConnected = std::chrono::milliseconds( 250 );
+static const auto kPollConnected      = std::chrono::milliseconds( 100 );
+
+static const char* QualityName( OMTQuality q )
+{
+    return ( q == OMTQuality_Default ) ? "default" : ( q == OMTQuality_Low ) ? "low"
+         : ( q == OMTQuality_Medium ) ? "medium" : "high";
+}
+
+// Tally Priority: frame rate while on preview only (fraction of the
+// selected rate) and while on neither program nor preview (keep-alive)
+static const double kTallyPreviewRateScale = 0.5;
+static const double kTallyIdleFps          = 1.0;
+
+// Pacing never holds a frame back longer than this past its render time;
+// it only has to absorb readback / copy jitter, not add real latency
+static const auto kMaxPaceDelay = std::chrono::milliseconds( 20 );
+
+// Longest Low Latency mode stalls the GL thread for the current frame's
+// readback before leaving it to the async path (nanoseconds)
+static const uint64_t kLowLatencyWaitNs = 8000000;
+
+// Preview stream: its readback ring depth (it is small, and nobody watches
+// thumbnails for latency) and the sender name suffix
+static const int  kPreviewReadbackDepth = 2;
+static const char kPreviewSuffix[]      = " (Preview)";
+
+// Most senders the Tiles param may create
+static const size_t kMaxTiles = 16;
+
+// Parses the Tiles param: empty = tiling off, "<cols>x<rows>" = an even
+// grid over the input, or "x,y,w,h; x,y,w,h; ..." = explicit rectangles in
+// input pixels from the top-left.  Anything else leaves tiling off and
+// returns false.
+static bool ParseTiles( const char* text, uint32_t& cols, uint32_t& rows,
+                        std::vector< OMTSend::TileRect >& rects )
+{
+    cols = rows = 0;
+    rects.clear();
+
+    auto space  = []( const char*& p ) { while( *p == ' ' || *p == '\t' ) ++p; };
+    auto number = [ & ]( const char*& p, uint32_t& out )
+    {
+        space( p );
+        if( *p < '0' || *p > '9' )
+            return false;
+        char* end = nullptr;
+        out = (uint32_t)std::strtoul( p, &end, 10 );
+        p   = end;
+        space( p );
+        return true;
+    };
+    auto expect = []( const char*& p, char c )
+    {
+        if( *p != c )
+            return false;
+        ++p;
+        return true;
+    };
+
+    const char* p = text;
+    space( p );
+    if( *p == '\0' )
+        return true;
+
+    uint32_t c = 0, r = 0;
+    const char* q = p;
+    if( number( q, c ) && ( expect( q, 'x' ) || expect( q, 'X' ) ) && number( q, r ) && *q == '\0' )
+    {
+        if( c == 0 || r == 0 || (size_t)c * r > kMaxTiles )
+            return false;
+        cols = c;
+        rows = r;
+        return true;
+    }
+
+    for( ;; )
+    {
+        OMTSend::TileRect t = {};
+        if( !number( p, t.x ) || !expect( p, ',' ) || !number( p, t.y ) || !expect( p, ',' ) ||
+            !number( p, t.w ) || !expect( p, ',' ) || !number( p, t.h ) ||
+            t.w == 0 || t.h == 0 || rects.size() == kMaxTiles )
+            break;
+        rects.push_back( t );
+
+        // Rectangles are separated by ';' (a trailing one is fine)
+        if( *p == '\0' )
+            return true;
+        if( !expect( p, ';' ) )
+            break;
+        space( p );
+        if( *p == '\0' )
+            return true;
+    }
+    rects.clear();
+    return false;
+}
+
 OMTSend::OMTSend()
     : CFFGLPlugin()
 {
@@ -53,23 +454,131 @@ OMTSend::OMTSend()
     SetParamInfof( PARAM_SOURCE_NAME, "Source Name", FF_TYPE_TEXT );
     SetParamInfof( PARAM_QUALITY,     "Quality",     FF_TYPE_STANDARD );
 
-    // Frame rate as a named dropdown - values 0..4 map to the 5 options
-    SetOptionParamInfo( PARAM_FRAMERATE, "Frame Rate", 6, 5.0f );
+    // Frame rate as a named dropdown - values 0..5 map to fixed rates,
+    // Auto advertises the host's measured render rate
+    SetOptionParamInfo( PARAM_FRAMERATE, "Frame Rate", 7, 5.0f );
     SetParamElementInfo( PARAM_FRAMERATE, 0, "24 fps",      0.0f );
     SetParamElementInfo( PARAM_FRAMERATE, 1, "25 fps",      1.0f );
     SetParamElementInfo( PARAM_FRAMERATE, 2, "29.97 fps",   2.0f );
     SetParamElementInfo( PARAM_FRAMERATE, 3, "30 fps",      3.0f );
     SetParamElementInfo( PARAM_FRAMERATE, 4, "50 fps",      4.0f );
     SetParamElementInfo( PARAM_FRAMERATE, 5, "60 fps",      5.0f );
+    SetParamElementInfo( PARAM_FRAMERATE, 6, "Auto",        6.0f );
 
     SetParamInfof( PARAM_LOGGING, "Enable Logging", FF_TYPE_BOOLEAN );
 
+    // Packing to YUV on the GPU halves (or better) the readback and spares
+    // libomt its own RGB->YUV conversion before encoding.  P216/PA16 keep
+    // 16-bit precision from a high bit depth composition all the way out.
+    SetOptionParamInfo( PARAM_PIXEL_FORMAT, "Pixel Format", 6, 0.0f );
+    SetParamElementInfo( PARAM_PIXEL_FORMAT, 0, "BGRA",        0.0f );
+    SetParamElementInfo( PARAM_PIXEL_FORMAT, 1, "UYVY",        1.0f );
+    SetParamElementInfo( PARAM_PIXEL_FORMAT, 2, "UYVA",        2.0f );
+    SetParamElementInfo( PARAM_PIXEL_FORMAT, 3, "NV12",        3.0f );
+    SetParamElementInfo( PARAM_PIXEL_FORMAT, 4, "P216 (16-bit)", 4.0f );
+    SetParamElementInfo( PARAM_PIXEL_FORMAT, 5, "PA16 (16-bit)", 5.0f );
+
+    // More buffers = more frames may be in flight before we have to skip
+    // one, at the cost of up to a frame of latency each
+    SetOptionParamInfo( PARAM_READBACK_DEPTH, "Readback Buffers", 5, 3.0f );
+    SetParamElementInfo( PARAM_READBACK_DEPTH, 0, "2",          2.0f );
+    SetParamElementInfo( PARAM_READBACK_DEPTH, 1, "3",          3.0f );
+    SetParamElementInfo( PARAM_READBACK_DEPTH, 2, "4",          4.0f );
+    SetParamElementInfo( PARAM_READBACK_DEPTH, 3, "5",          5.0f );
+    SetParamElementInfo( PARAM_READBACK_DEPTH, 4, "6",          6.0f );
+
+    // Send straight from persistently mapped readback buffers (needs
+    // GL_ARB_buffer_storage; ignored otherwise)
+    SetParamInfof( PARAM_ZERO_COPY, "Zero Copy", FF_TYPE_BOOLEAN );
+
+    // Don't re-encode frames identical to the last one sent (paused clips,
+    // stills); one is still sent every kDuplicateKeepAlive
+    SetParamInfo( PARAM_SKIP_DUPLICATES, "Skip Duplicates", FF_TYPE_BOOLEAN, true );
+
+    // Send each frame as soon as it is rendered, at the cost of waiting on
+    // the GPU every frame, instead of one frame later
+    SetParamInfof( PARAM_LOW_LATENCY, "Low Latency", FF_TYPE_BOOLEAN );
+
+    // Leave encode quality to the receivers' suggestions (Quality is then
+    // ignored) and lower the send rate while the encoder can't keep up,
+    // instead of dropping frames at random.  Switching it recreates the
+    // sender, so receivers reconnect once.
+    SetParamInfof( PARAM_ADAPTIVE_QUALITY, "Adaptive Quality", FF_TYPE_BOOLEAN );
+
+    // Full rate on program, half on preview, keep-alive otherwise - for rigs
+    // with many sources of which only a few are on air at once
+    SetParamInfof( PARAM_TALLY_PRIORITY, "Tally Priority", FF_TYPE_BOOLEAN );
+
+    // A second, downscaled sender named "<Source Name> (Preview)" for
+    // multiviewers, so thumbnails don't cost a full-resolution encode
+    SetOptionParamInfo( PARAM_PREVIEW, "Preview Stream", 3, 0.0f );
+    SetParamElementInfo( PARAM_PREVIEW, 0, "Off",       0.0f );
+    SetParamElementInfo( PARAM_PREVIEW, 1, "1/4 Size",  1.0f );
+    SetParamElementInfo( PARAM_PREVIEW, 2, "1/8 Size",  2.0f );
+
+    // Video walls: one sender per tile instead of the whole input, named
+    // "<Source Name> (Tile N)" - a grid like "4x2", or rectangles like
+    // "0,0,1920,1080; 1920,0,1920,1080".  Each tile reads back only its
+    // own region, so the cost follows the wall's pixels, not tiles x canvas.
+    SetParamInfof( PARAM_TILES, "Tiles", FF_TYPE_TEXT );
+
+    // Scale the whole-input stream on the GPU before readback, so readback,
+    // copy and encode follow the delivered size rather than the composition.
+    // Fixed sizes keep the aspect ratio and never scale up.
+    SetOptionParamInfo( PARAM_OUTPUT_SIZE, "Output Size", 6, 0.0f );
+    SetParamElementInfo( PARAM_OUTPUT_SIZE, 0, "Input",     0.0f );
+    SetParamElementInfo( PARAM_OUTPUT_SIZE, 1, "2160p",     1.0f );
+    SetParamElementInfo( PARAM_OUTPUT_SIZE, 2, "1080p",     2.0f );
+    SetParamElementInfo( PARAM_OUTPUT_SIZE, 3, "720p",      3.0f );
+    SetParamElementInfo( PARAM_OUTPUT_SIZE, 4, "1/2 Size",  4.0f );
+    SetParamElementInfo( PARAM_OUTPUT_SIZE, 5, "1/4 Size",  5.0f );
+
+    // Area averages every input pixel (best for downscaling); bilinear is
+    // the cheapest, bicubic the sharpest
+    SetOptionParamInfo( PARAM_SCALE_FILTER, "Scale Filter", 3, 2.0f );
+    SetParamElementInfo( PARAM_SCALE_FILTER, 0, "Bilinear", 0.0f );
+    SetParamElementInfo( PARAM_SCALE_FILTER, 1, "Bicubic",  1.0f );
+    SetParamElementInfo( PARAM_SCALE_FILTER, 2, "Area",     2.0f );
+
+    // Instances reading back the same texture the same way share one
+    // transfer and copy (see ReadbackCache)
+    SetParamInfof( PARAM_SHARE_READBACK, "Share Readback", FF_TYPE_BOOLEAN );
+
+    // GL thread time all OMTSend streams in the process may spend on
+    // readback per host frame; the rest is deferred to later frames.
+    // The smallest budget any instance asks for applies.
+    SetOptionParamInfo( PARAM_READBACK_BUDGET, "Readback Budget", 4, 0.0f );
+    SetParamElementInfo( PARAM_READBACK_BUDGET, 0, "Unlimited", 0.0f );
+    SetParamElementInfo( PARAM_READBACK_BUDGET, 1, "2 ms",      1.0f );
+    SetParamElementInfo( PARAM_READBACK_BUDGET, 2, "4 ms",      2.0f );
+    SetParamElementInfo( PARAM_READBACK_BUDGET, 3, "8 ms",      3.0f );
+
+    // Read each frame back in horizontal bands, all issued together and
+    // each mapped and copied as soon as it lands, so an 8K+ frame's copy
+    // starts before the whole transfer is done.  Adds a frame of latency;
+    // the send rate stays at the host rate.
+    SetOptionParamInfo( PARAM_READBACK_STRIPES, "Readback Stripes", 4, 0.0f );
+    SetParamElementInfo( PARAM_READBACK_STRIPES, 0, "Off", 0.0f );
+    SetParamElementInfo( PARAM_READBACK_STRIPES, 1, "2",   1.0f );
+    SetParamElementInfo( PARAM_READBACK_STRIPES, 2, "4",   2.0f );
+    SetParamElementInfo( PARAM_READBACK_STRIPES, 3, "8",   3.0f );
+
+    // Map, copy and repack readbacks on a background thread with its own
+    // shared GL context; the render thread only records the transfer
+    SetParamInfof( PARAM_READBACK_THREAD, "Readback Thread", FF_TYPE_BOOLEAN );
+
+    AddStream();   // the whole input, until tiled
+
     mSourceName = "Resolume OMT";
     UpdateFrameRate( 5.0f );  // default to 60fps
+
+    OMTRowCopy::Acquire();
 }
 
 OMTSend::~OMTSend()
 {
+    StopSending();   // the executor must not run a task of a freed stream
+    OMTRowCopy::Release();
 }
 
 FFResult OMTSend::InitGL( const FFGLViewportStruct* vp )
@@ -98,20 +607,27 @@ FFResult OMTSend::InitGL( const FFGLViewportStruct* vp )
     glBindBuffer( GL_ARRAY_BUFFER, 0 );
     glBindVertexArray( 0 );
 
+    // The capture pass is an optimisation, not a requirement: if it fails to
+    // build we fall back to reading the input directly and flipping rows on
+    // the CPU.
+    mCaptureReady = mCaptureShader.Compile( kCaptureVertexShader, kCaptureFragmentShader );
+
     mShaderReady = true;
-    glGenBuffers( 2, mPBO );
     return FF_SUCCESS;
 }
 
 FFResult OMTSend::DeInitGL()
 {
-    StopSendThread();  // thread destroys sender before exiting
+    StopSending();
+    for( auto& s : mStreams )
+        ReleaseStream( *s );
     mShader.FreeGLResources();
+    mCaptureShader.FreeGLResources();
+    mCaptureReady = false;
+    if( mInputFBO ) { glDeleteFramebuffers( 1, &mInputFBO ); mInputFBO = 0; }
     if( mVAO ) { glDeleteVertexArrays( 1, &mVAO ); mVAO = 0; }
     if( mVBO ) { glDeleteBuffers( 1, &mVBO ); mVBO = 0; }
-    if( mPBO[0] ) { glDeleteBuffers( 2, mPBO ); mPBO[0] = mPBO[1] = 0; }
-    mPBOReady = false;
-    mPBOSize  = 0;
+    mDecimator.Reset();
     mShaderReady = false;
     return FF_SUCCESS;
 }
@@ -121,21 +637,20 @@ FFResult OMTSend::ProcessOpenGL( ProcessOpenGLStruct* pGL )
     if( !mShaderReady || pGL->numInputTextures < 1 || !pGL->inputTextures[ 0 ] )
         return FF_FAIL;
 
-    // Start the send thread on the first frame - by this point Resolume has
-    // finished setting all parameters (including Source Name) so we get the
-    // correct name from the start rather than an empty string.
-    if( !mRunSendThread )
-        StartSendThread();
-
     const FFGLTextureStruct& inputTex = *pGL->inputTextures[ 0 ];
     if( inputTex.Handle == 0 || inputTex.Width == 0 || inputTex.Height == 0 ||
         inputTex.HardwareWidth == 0 || inputTex.HardwareHeight == 0 )
         return FF_SUCCESS;  // texture not ready yet – skip silently
 
-    // Use actual video dimensions (not HardwareWidth which may be power-of-2 padded)
-    const uint32_t w      = inputTex.Width;
-    const uint32_t h      = inputTex.Height;
-    const uint32_t stride = w * 4;  // BGRA = 4 bytes/pixel
+    // Match the streams to the Tiles and Preview Stream params (restarts
+    // sending if senders have to be added or removed)
+    UpdateStreams( inputTex.Width, inputTex.Height );
+
+    // Start sending on the first frame - by this point Resolume has
+    // finished setting all parameters (including Source Name) so we get the
+    // correct name from the start rather than an empty string.
+    if( !mSending )
+        StartSending();
 
     // 1. Pass-through render
     {
@@ -152,79 +667,32 @@ FFResult OMTSend::ProcessOpenGL( ProcessOpenGLStruct* pGL )
         glBindVertexArray( 0 );
     }
 
-    // -----------------------------------------------------------------------
-    // Async GPU->CPU readback using two PBOs (double-buffer).
-    //
-    // This frame:
-    //   1. Map the READ PBO (filled by last frame's glGetTexImage) and hand
-    //      the pixels to the send thread — no GPU stall because the DMA
-    //      completed during the intervening frame.
-    //   2. Bind the WRITE PBO and call glGetTexImage to kick off the next
-    //      async DMA transfer — returns immediately.
-    //   3. Swap read/write indices for next frame.
-    //
-    // On the very first frame mPBOReady is false so we skip step 1.
-    // -----------------------------------------------------------------------
-
-    const uint32_t hw     = inputTex.HardwareWidth;
-    const uint32_t hh     = inputTex.HardwareHeight;
-    const size_t   hwSize = (size_t)hw * hh * 4;
-
-    // Reallocate both PBOs if the texture size changed
-    if( hwSize != mPBOSize )
-    {
-        for( int i = 0; i < 2; ++i )
-        {
-            glBindBuffer( GL_PIXEL_PACK_BUFFER, mPBO[i] );
-            glBufferData( GL_PIXEL_PACK_BUFFER, (GLsizeiptr)hwSize, nullptr, GL_STREAM_READ );
-        }
-        glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
-        mPBOSize  = hwSize;
-        mPBOReady = false;  // discard any in-flight frame at old size
-    }
-
-    const int readIdx  = mPBOWriteIdx;        // what we wrote last frame
-    const int writeIdx = 1 - mPBOWriteIdx;    // what we write this frame
+    // Only read back the host frames the selected OMT frame rate needs; the
+    // rest would just be overwritten before the send thread got to them.
+    // Every stream takes the same host frames.
+    const bool frameDue = mDecimator.Tick( FrameDecimator::Clock::now(), SendRateTarget() );
+    if( mAutoFrameRate )
+        UpdateAutoFrameRate();
 
-    // --- Step 1: read last frame's PBO ---
-    if( mPBOReady )
+    // 2. Readback for each stream.  The render time is taken once, so every
+    // stream - every tile of a wall in particular - stamps this host frame
+    // with the same timestamp.
+    // Each stream's GL time is booked against the process-wide budget.
+    const OMTVideoFrame::Clock::time_point captured = OMTVideoFrame::Clock::now();
+    ReadbackScheduler& scheduler = ReadbackScheduler::Instance();
+    const double       budgetMs  = ReadbackBudgetMs();
+    for( auto& s : mStreams )
     {
-        const PendingFrame& pf = mPending;
-
-        glBindBuffer( GL_PIXEL_PACK_BUFFER, mPBO[readIdx] );
-        const uint8_t* src = reinterpret_cast<const uint8_t*>(
-            glMapBuffer( GL_PIXEL_PACK_BUFFER, GL_READ_ONLY ) );
-
-        if( src )
-        {
-            // Flip rows: glGetTexImage reads bottom-to-top, OMT expects top-to-bottom.
-            // This also handles the hw != w padding case since we copy pf.stride bytes
-            // from each source row (skipping any padding columns on the right).
-            mCropBuf.resize( (size_t)pf.stride * pf.h );
-            for( uint32_t row = 0; row < pf.h; ++row )
-                std::memcpy( mCropBuf.data() + row * pf.stride,
-                             src + ( pf.h - 1 - row ) * pf.hw * 4,
-                             pf.stride );
-            mVideoBuffer.Write( pf.w, pf.h, pf.stride, mCropBuf.data(), mCropBuf.size() );
-            glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
-        }
-        glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+        const ReadbackScheduler::Clock::time_point start = ReadbackScheduler::Clock::now();
+        scheduler.Begin( s.get(), budgetMs, start );
+        ReadbackStream( *s, inputTex, pGL->HostFBO, frameDue, captured );
+        scheduler.End( s.get(), std::chrono::duration< double, std::milli >(
+                                    ReadbackScheduler::Clock::now() - start ).count() );
     }
 
-    // --- Step 2: kick off async DMA into write PBO ---
-    glBindBuffer( GL_PIXEL_PACK_BUFFER, mPBO[writeIdx] );
-    glBindTexture( GL_TEXTURE_2D, inputTex.Handle );
-    glGetTexImage( GL_TEXTURE_2D, 0, GL_BGRA, GL_UNSIGNED_BYTE, nullptr ); // nullptr = write to PBO
-    glBindTexture( GL_TEXTURE_2D, 0 );
-    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
-
-    // Save dimensions for next frame's read step
-    mPending     = { w, h, hw, stride };
-    mPBOWriteIdx = writeIdx;
-    mPBOReady    = true;
-
     // Debug: log once to confirm readback is working
-    if( !mDebugLogged && mPBOReady && mLoggingEnabled )
+    const Stream& main = *mStreams[ 0 ];
+    if( !mDebugLogged && mLoggingEnabled && main.readback.Depth() > 0 )
     {
         mDebugLogged = true;
         static int sAnchor = 0;
@@ -239,203 +707,1449 @@ FFResult OMTSend::ProcessOpenGL( ProcessOpenGLStruct* pGL )
             if( sl ) wcscpy_s( sl + 1, MAX_PATH - (sl - path) - 1, L"omtsend_debug.txt" );
             std::ofstream dbg( path, std::ios::app );
             if( dbg )
-                dbg << "PBO readback active: w=" << w << " h=" << h
-                    << " hw=" << hw << " hh=" << hh << "\n";
+                dbg << "PBO readback active: w=" << inputTex.Width << " h=" << inputTex.Height
+                    << " hw=" << inputTex.HardwareWidth << " hh=" << inputTex.HardwareHeight
+                    << " ring=" << main.readback.Depth()
+                    << ( main.readback.Persistent() ? " zero-copy" : "" )
+                    << ( mLowLatency ? " low-latency" : "" )
+                    << ( main.thread ? " readback-thread" : "" )
+                    << " streams=" << mStreams.size() << "\n";
         }
     }
 
     return FF_SUCCESS;
 }
 
-FFResult OMTSend::SetFloatParameter( unsigned int index, float value )
+// -----------------------------------------------------------------------
+// Async GPU->CPU readback of one stream through its fenced ring of PBOs.
+//
+// This frame:
+//   1. Poll the ring for the newest transfer whose fence has signalled,
+//      map it and hand the pixels to the send thread.  Nothing landed
+//      yet means nothing is handed off - we never map a PBO the GPU may
+//      still be writing, so glMapBuffer cannot stall.
+//   2. If the frame rate decimator wants this host frame, take a free
+//      slot, render the capture pass and glReadPixels into it to kick
+//      off the next async DMA transfer, then fence it.  If every slot is
+//      still in flight the GPU is behind: skip this frame rather than
+//      wait for it.
+//
+// That costs a host frame of latency.  Low Latency mode skips step 1
+// and instead waits (bounded) for the transfer issued in step 2, so a
+// frame goes out during the host frame it was rendered in.
+// -----------------------------------------------------------------------
+void OMTSend::ReadbackStream( Stream& s, const FFGLTextureStruct& inputTex, GLuint hostFBO,
+                              bool frameDue, OMTVideoFrame::Clock::time_point captured )
 {
-    if( index == PARAM_QUALITY )
-    {
-        mQuality = std::clamp( value, 0.0f, 1.0f );
-        return FF_SUCCESS;
-    }
-    if( index == PARAM_FRAMERATE )
+    // Source region, clipped to the input (tile rectangles are typed in
+    // before the input size is known)
+    const uint32_t x  = std::min( s.rect.x, inputTex.Width );
+    const uint32_t y  = std::min( s.rect.y, inputTex.Height );
+    const uint32_t rw = s.rect.w ? std::min( s.rect.w, inputTex.Width - x ) : inputTex.Width - x;
+    const uint32_t rh = s.rect.h ? std::min( s.rect.h, inputTex.Height - y ) : inputTex.Height - y;
+
+    // Output size: the region divided by `scale`, then shrunk to fit
+    // fitW x fitH.  Scaled streams are rounded down to whole 4 x 2 blocks so
+    // every pixel format can pack them.
+    uint32_t w = rw / s.scale, h = rh / s.scale;
+    if( s.fitW > 0 && ( w > s.fitW || h > s.fitH ) )
     {
-        mFrameRateOption = value;
-        UpdateFrameRate( mFrameRateOption );
-        return FF_SUCCESS;
+        const double k = std::min( (double)s.fitW / w, (double)s.fitH / h );
+        w = (uint32_t)( w * k + 0.5 );
+        h = (uint32_t)( h * k + 0.5 );
     }
-    if( index == PARAM_LOGGING )
+    const bool scaled = ( w != rw || h != rh );
+    if( scaled )
     {
-        mLoggingEnabled = ( value > 0.5f );
-        return FF_SUCCESS;
+        w &= ~3u;
+        h &= ~1u;
     }
-    return FF_FAIL;
-}
-
-float OMTSend::GetFloatParameter( unsigned int index )
-{
-    if( index == PARAM_QUALITY )   return mQuality;
-    if( index == PARAM_FRAMERATE ) return mFrameRateOption;
-    if( index == PARAM_LOGGING )   return mLoggingEnabled ? 1.0f : 0.0f;
-    return 0.0f;
-}
+    const bool     region = ( rw != inputTex.Width || rh != inputTex.Height );
+    const uint32_t hw     = inputTex.HardwareWidth;
+    const uint32_t hh     = inputTex.HardwareHeight;
+    if( w == 0 || h == 0 )
+        return;
 
-FFResult OMTSend::SetTextParameter( unsigned int index, const char* value )
-{
-    if( index == PARAM_SOURCE_NAME && value )
+    // The capture pass reads back exactly the visible region, packed to the
+    // selected pixel format; the fallback path can only produce BGRA, and
+    // only has to transfer the whole (possibly padded) texture if neither
+    // glGetTextureSubImage nor a framebuffer read is available.  Only the
+    // capture pass can scale, and a whole-texture read can't take a region.
+    PackLayout layout = ChoosePackLayout( PixelFormatOption(), w, h );
+    const bool capture = mCaptureReady &&
+                         EnsureCaptureTarget( s, layout.targetW, layout.targetH, layout.targetFormat );
+    if( !capture && scaled )
+        return;
+    DirectRead direct = DirectRead::SubImage;
+    if( !capture )
     {
-        // Resolume sends "" on load before the user has set anything;
-        // treat that as "use the default" rather than blanking the name.
-        std::string newName = ( value[0] != '\0' ) ? value : "Resolume OMT";
-        if( mSourceName != newName )
-        {
-            mSourceName = newName;
-            // Restart the send thread so omt_send_create picks up the new name
-            if( mRunSendThread )
-            {
-                StopSendThread();
-                mDebugLogged = false;
-                StartSendThread();
-            }
-        }
-        return FF_SUCCESS;
+        layout = ChoosePackLayout( PIXFMT_BGRA, w, h );
+        direct = ChooseDirectRead( inputTex );
     }
-    return FF_FAIL;
-}
 
-char* OMTSend::GetTextParameter( unsigned int index )
-{
-    if( index == PARAM_SOURCE_NAME ) return const_cast< char* >( mSourceName.c_str() );
-    return nullptr;
-}
+    const bool   whole   = !capture && direct == DirectRead::WholeTexture;
+    if( whole && region )
+        return;
 
+    // Readback Stripes: bands are rows of the capture target, so only the
+    // capture pass can be striped
+    const int stripes = capture ? ReadbackStripesOption() : 1;
 
+    // Readback Thread: the background thread finishes this stream's
+    // readbacks.  Striped frames are put together on the GL thread, so they
+    // stay here.  Without a shared context, everything stays here.
+    const bool threaded = mReadbackThread && stripes == 1;
+    if( threaded && !s.thread )
+        s.thread = ReadbackThread::Acquire();
+    else if( s.thread && ( !threaded || s.thread->Failed() ) )
+        DetachReadbackThread( s );
 
-void OMTSend::StartSendThread()
-{
-    if( mRunSendThread ) return;
-    mRunSendThread = true;
-    mSendThread    = std::thread( &OMTSend::SendThreadFunc, this );
-}
+    // Share Readback: attach to the process-wide entry for exactly this read.
+    // A striped frame is assembled in the stream's own video buffer band by
+    // band, and the readback thread writes to the stream's
+    // video buffer directly, so neither of them shares.
+    ReadbackCache& cache = ReadbackCache::Instance();
+    if( mShareReadback && stripes == 1 && !s.thread )
+    {
+        const ReadbackCache::Key key = { wglGetCurrentContext(), inputTex.Handle, x, y, rw, rh,
+                                         w, h, layout.codec, (int)s.filter };
+        s.shared = cache.Attach( s.shared, key, &s );
+    }
+    else if( s.shared )
+    {
+        cache.Detach( s.shared, &s );
+        s.shared = nullptr;
+    }
+    const size_t pboSize = capture ? (size_t)layout.targetW * layout.targetH * layout.texelBytes
+                         : whole   ? (size_t)hw * hh * 4
+                                   : (size_t)w * h * 4;
 
-void OMTSend::StopSendThread()
-{
-    mRunSendThread = false;
-    if( mSendThread.joinable() )
-        mSendThread.join();
-}
+    // Zero-copy sends straight out of persistently mapped PBOs, which only
+    // works when the readback is already in its final layout - and all in
+    // one slot, which a striped frame isn't.  The readback thread maps the
+    // buffers itself, in its own context.
+    const bool zeroCopy = mZeroCopy && capture && stripes == 1 && !s.thread;
 
-void OMTSend::SendThreadFunc()
-{
-    // Resolve the folder where our plugin DLL lives.
-    // Using FROM_ADDRESS on a local static ensures we get the plugin's own path,
-    // not libomt.dll which may be in a different directory.
-    std::wstring pluginDir;
+    // A striped ring holds bands, and needs a slot for every band of a frame
+    const uint32_t bandRows = ( layout.targetH + stripes - 1 ) / stripes;
+    const size_t   slotSize = stripes > 1 ? (size_t)layout.targetW * bandRows * layout.texelBytes : pboSize;
+    int depth = s.depth > 0 ? s.depth : ReadbackDepthOption();
+    if( stripes > 1 )
+        depth = std::max( depth, stripes );
+
+    // Rebuild the ring if the readback size, requested depth or mapping mode
+    // changed; any frame in flight at the old size is discarded
+    if( s.readback.Configure( depth, slotSize, zeroCopy ) )
     {
-        static int sAnchor = 0;
-        wchar_t path[ MAX_PATH ] = {};
-        HMODULE hm = nullptr;
-        if( GetModuleHandleExW( GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
-                                GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
-                                (LPCWSTR)&sAnchor, &hm ) )
-        {
-            GetModuleFileNameW( hm, path, MAX_PATH );
-            wchar_t* sl = wcsrchr( path, L'\\' );
-            if( sl ) pluginDir = std::wstring( path, sl + 1 );
-        }
-        if( pluginDir.empty() ) pluginDir = L".\\";
+        s.pending.assign( (size_t)s.readback.Depth(), PendingFrame{} );
+        s.striped = {};
     }
-    std::wstring vmxPath  = pluginDir + L"libvmx.dll";
-    std::wstring omtLog   = pluginDir + L"libomt_send.log";
-    std::wstring debugLog = pluginDir + L"omtsend_debug.txt";
 
-    // Pre-load libvmx.dll explicitly — .NET NativeAOT P/Invoke won't find it otherwise
-    HMODULE hvmx = LoadLibraryW( vmxPath.c_str() );
-    if( mLoggingEnabled )
+    // Nobody is connected: skip the readback, copy and hand-off entirely.
+    // Transfers still in flight are drained so the first frame a new
+    // receiver gets isn't one left over from before it connected.
+    if( s.connections.load() == 0 )
     {
-        std::ofstream dbg( debugLog, std::ios::app );
-        if( dbg )
-        {
-            dbg << "libvmx load: " << ( hvmx ? "OK" : "FAILED" )
-                << " err=" << GetLastError() << "\n";
-        }
+        if( s.shared )
+            cache.Yield( s.shared, &s );   // let a stream with receivers produce
+        const int stale = s.readback.PollReady();
+        if( stale >= 0 )
+            s.readback.Recycle( stale );
+        s.striped = {};
+        return;
     }
 
-    // Direct OMT's own log to the plugin folder (only if logging enabled)
-    if( mLoggingEnabled )
+    // Another stream already reads this back: pass its frames on instead
+    // of reading back again.  The frames arrive at the producer's cadence.
+    s.producing = s.shared && cache.Users( s.shared ) > 1;
+    if( s.producing && !cache.Claim( s.shared, &s, ReadbackScheduler::Instance().Frame() ) )
     {
-        std::string omtLogA( omtLog.begin(), omtLog.end() );
-        omt_setloggingfilename( omtLogA.c_str() );
+        s.producing = false;
+        HandOffShared( s );
+        const int stale = s.readback.PollReady();
+        if( stale >= 0 )
+            s.readback.Recycle( stale );
+        return;
     }
 
-    mOMTSender = omt_send_create( mSourceName.c_str(), QualityEnum() );
-    if( !mOMTSender )
+    if( stripes > 1 )
     {
-        if( mLoggingEnabled )
-        {
-            std::ofstream dbg( debugLog, std::ios::app );
-            if( dbg ) dbg << "omt_send_create FAILED for name='" << mSourceName << "'\n";
-        }
+        ReadbackStriped( s, inputTex, layout, { x, y, rw, rh }, w, h, stripes, hostFBO, frameDue, captured );
         return;
     }
 
-    if( mLoggingEnabled )
+    // --- Step 1: hand off the newest completed readback ---
+    // Low latency mode instead collects this frame's own readback once it
+    // has been issued (step 3), which supersedes anything older.  With the
+    // readback thread, that thread hands off; anything landing here was
+    // issued before it took over.
+    const bool lowLatency = mLowLatency && frameDue && !s.thread;
+    if( s.thread )
     {
-        char addr[1024] = {};
-        omt_send_getaddress( mOMTSender, addr, sizeof(addr) );
-        std::ofstream dbg( debugLog, std::ios::app );
-        if( dbg ) dbg << "omt_send_create OK, address='" << addr << "'\n";
+        const int stale = s.readback.PollReady();
+        if( stale >= 0 )
+            s.readback.Recycle( stale );
     }
+    else if( !lowLatency )
+        HandOffReadback( s, s.readback.PollReady() );
 
-    std::vector< uint8_t > pixelBuf;
+    // --- Step 2: kick off async DMA into a free slot ---
+    if( !frameDue )
+        return;   // decimated: not needed for the target frame rate
 
-    while( mRunSendThread )
+    // Over the process-wide GL budget for this host frame: try again on the
+    // next one.  Program tally is never deferred.
+    if( !ReadbackScheduler::Instance().Request( &s, pboSize, s.tally.load() == TALLY_PROGRAM ) )
     {
-        uint32_t w = 0, h = 0, stride = 0;
+        ++s.framesDeferred;
+        if( lowLatency )
+            HandOffReadback( s, s.readback.PollReady() );
+        return;
+    }
 
-        if( mVideoBuffer.Read( w, h, stride, pixelBuf ) )
-        {
-            OMTMediaFrame frame = {};
-            frame.Type          = OMTFrameType_Video;
-            frame.Codec         = OMTCodec_BGRA;
-            frame.Width         = (int)w;
-            frame.Height        = (int)h;
-            frame.Stride        = (int)stride;
-            frame.FrameRateN    = mFrameRateN.load();
-            frame.FrameRateD    = mFrameRateD.load();
-            frame.Timestamp     = -1;
-            frame.AspectRatio   = (float)w / (float)h;
-            frame.ColorSpace    = OMTColorSpace_BT709;
-            frame.Flags         = OMTVideoFlags_Alpha;
-            frame.Data          = pixelBuf.data();
-            frame.DataLength    = (int)pixelBuf.size();
-
-            omt_send( mOMTSender, &frame );
-        }
-        else
-        {
-            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
-        }
+    const int writeIdx = s.readback.Acquire();
+    if( writeIdx < 0 )
+    {
+        // Ring full: GPU hasn't finished the older transfers
+        if( lowLatency )
+            HandOffReadback( s, s.readback.PollReady() );
+        return;
     }
 
-    omt_send_destroy( mOMTSender );
-    mOMTSender = nullptr;
-}
+    if( capture )
+    {
+        RenderCapture( s, inputTex, layout, { x, y, rw, rh }, w, h, hostFBO );
 
-OMTQuality OMTSend::QualityEnum() const
-{
-    if( mQuality < 0.33f ) return OMTQuality_Low;
-    if( mQuality < 0.67f ) return OMTQuality_Medium;
-    return OMTQuality_High;
+        glBindFramebuffer( GL_READ_FRAMEBUFFER, s.captureFBO );
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, s.readback.Buffer( writeIdx ) );
+        glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+        glReadPixels( 0, 0, (GLsizei)layout.targetW, (GLsizei)layout.targetH,
+                      layout.readFormat, layout.readType, nullptr ); // nullptr = write to PBO
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+        glBindFramebuffer( GL_FRAMEBUFFER, hostFBO );
+    }
+    else if( direct == DirectRead::SubImage )
+    {
+        // Just the visible w x h (or the tile), bottom row first
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, s.readback.Buffer( writeIdx ) );
+        glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+        glGetTextureSubImage( inputTex.Handle, 0, (GLint)x, (GLint)( inputTex.Height - y - h ), 0,
+                              (GLsizei)w, (GLsizei)h, 1,
+                              GL_BGRA, GL_UNSIGNED_BYTE, (GLsizei)pboSize, nullptr ); // nullptr = write to PBO
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    }
+    else if( direct == DirectRead::Framebuffer )
+    {
+        // ChooseDirectRead() left the input attached to mInputFBO
+        glBindFramebuffer( GL_READ_FRAMEBUFFER, mInputFBO );
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, s.readback.Buffer( writeIdx ) );
+        glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+        glReadPixels( (GLint)x, (GLint)( inputTex.Height - y - h ), (GLsizei)w, (GLsizei)h,
+                      GL_BGRA, GL_UNSIGNED_BYTE, nullptr ); // nullptr = write to PBO
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+        glBindFramebuffer( GL_FRAMEBUFFER, hostFBO );
+    }
+    else
+    {
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, s.readback.Buffer( writeIdx ) );
+        glBindTexture( GL_TEXTURE_2D, inputTex.Handle );
+        glGetTexImage( GL_TEXTURE_2D, 0, GL_BGRA, GL_UNSIGNED_BYTE, nullptr ); // nullptr = write to PBO
+        glBindTexture( GL_TEXTURE_2D, 0 );
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    }
+    s.readback.Issue( writeIdx );
+
+    // Save dimensions for when this slot is read back
+    s.pending[ writeIdx ] = { w, h, whole ? hw : w, capture, layout, captured };
+
+    // Readback Thread: flush so the fence signals without any help from this
+    // context, and leave waiting, mapping and copying to the thread
+    if( s.thread )
+    {
+        glFlush();
+        GLsync fence = nullptr;
+        std::atomic<int>* refs = s.readback.HandOver( writeIdx, fence );
+        Stream* const      sp  = &s;
+        const PendingFrame pf  = s.pending[ writeIdx ];
+        s.thread->Submit( &s, fence, s.readback.Buffer( writeIdx ), s.readback.SlotBytes(), refs,
+                          [ sp, pf ]( const uint8_t* src )
+                          {
+                              CopyReadback( sp->video.BeginWrite( pf.w, pf.h, pf.layout.stride,
+                                                                  pf.layout.dataBytes, pf.captured ),
+                                            src, pf );
+                              sp->video.CommitWrite( pf.layout.codec, pf.layout.colorSpace );
+                          } );
+        return;
+    }
+
+    // --- Step 3 (low latency only): wait for this frame's own readback ---
+    // Stalls the GL thread until the GPU has rendered and transferred the
+    // frame (bounded, so a slow GPU degrades to the async path), and hands
+    // it to the send thread - which is woken by the publish - straight away.
+    if( lowLatency )
+        HandOffReadback( s, s.readback.WaitReady( kLowLatencyWaitNs ) );
+}
+
+// Passes a landed readback slot (from PollReady / WaitReady; -1 = none) to
+// the send thread and returns it to the ring.
+void OMTSend::HandOffReadback( Stream& s, int readIdx )
+{
+    if( readIdx < 0 )
+        return;
+
+    const PendingFrame& pf = s.pending[ readIdx ];
+    if( pf.band >= 0 )
+    {
+        s.readback.Recycle( readIdx );   // a band left over from Readback Stripes
+        return;
+    }
+    if( pf.packed && s.readback.Persistent() && !s.producing )
+    {
+        // Lend the mapped slot to the send thread - no copy on this thread at
+        // all.  It stays out of the ring until omt_send has finished with it.
+        // A slot that lost its mapping is dropped along with its frame.
+        const uint8_t* mapped = s.readback.Map( readIdx );
+        if( !mapped )
+        {
+            s.readback.Recycle( readIdx );
+            return;
+        }
+        s.video.WriteExternal( pf.w, pf.h, pf.layout.stride,
+                               pf.layout.codec, pf.layout.colorSpace,
+                               mapped, pf.layout.dataBytes,
+                               s.readback.Lend( readIdx ), pf.captured );
+        return;
+    }
+
+    const uint8_t* src = s.readback.Map( readIdx );
+    if( src )
+    {
+        // Producing a shared readback: land the frame in a shared copy that
+        // every attached stream (this one included) sends from.  Otherwise
+        // straight into the slot the send thread will consume.
+        ReadbackCache::Frame* shared = s.producing
+            ? ReadbackCache::Instance().Acquire( s.shared, pf.layout.dataBytes ) : nullptr;
+        uint8_t* dst = shared ? shared->pixels.data()
+                              : s.video.BeginWrite( pf.w, pf.h, pf.layout.stride,
+                                                    pf.layout.dataBytes, pf.captured );
+        CopyReadback( dst, src, pf );
+
+        if( shared )
+        {
+            shared->w          = pf.w;
+            shared->h          = pf.h;
+            shared->stride     = pf.layout.stride;
+            shared->codec      = pf.layout.codec;
+            shared->colorSpace = pf.layout.colorSpace;
+            shared->captured   = pf.captured;
+            ReadbackCache::Instance().Publish( s.shared, shared, ReadbackScheduler::Instance().Frame() );
+            HandOffShared( s );
+        }
+        else
+            s.video.CommitWrite( pf.layout.codec, pf.layout.colorSpace );
+        s.readback.Unmap( readIdx );
+    }
+    s.readback.Recycle( readIdx );
+}
+
+// -----------------------------------------------------------------------
+// Striped readback (Readback Stripes) of one stream.
+//
+// A frame's capture pass is rendered once and every band of its capture
+// target read back straight away, each into its own ring slot - issuing a
+// transfer into a PBO costs the CPU next to nothing.  Bands are then mapped
+// and copied into place one by one as their fences signal, rather than all
+// at once when the whole frame has landed, so an 8K+ frame's map and copy
+// start while the rest of it is still in transit.  The frame goes to the
+// send thread once all of its bands have landed - normally on the next
+// host frame, which then starts the following one, so the send rate isn't
+// cut by the band count.
+// -----------------------------------------------------------------------
+void OMTSend::ReadbackStriped( Stream& s, const FFGLTextureStruct& inputTex, const PackLayout& layout,
+                               const TileRect& region, uint32_t w, uint32_t h, int bands,
+                               GLuint hostFBO, bool frameDue, OMTVideoFrame::Clock::time_point captured )
+{
+    StripedFrame& sf = s.striped;
+
+    // Copy in every band that has landed, in the order they were issued
+    for( int readIdx = s.readback.PollNext(); readIdx >= 0; readIdx = s.readback.PollNext() )
+        HandOffBand( s, readIdx );
+
+    // The pixel format or size changed under a frame still being read back:
+    // its capture target has been re-created, so drop the frame
+    if( sf.bands > 0 && ( sf.layout.codec != layout.codec ||
+                          sf.layout.targetW != layout.targetW || sf.layout.targetH != layout.targetH ) )
+        sf = {};
+
+    // Still landing, or decimated: no new frame needed
+    if( sf.bands > 0 || !frameDue )
+        return;
+
+    // Bands are whole rows, so small targets may need fewer of them
+    const uint32_t bandRows = ( layout.targetH + bands - 1 ) / bands;
+    const int      count    = (int)( ( layout.targetH + bandRows - 1 ) / bandRows );
+    if( s.readback.Available() < count )
+        return;   // GPU hasn't finished the older bands
+
+    if( !ReadbackScheduler::Instance().Request( &s, (size_t)layout.targetW * layout.targetH * layout.texelBytes,
+                                                s.tally.load() == TALLY_PROGRAM ) )
+    {
+        ++s.framesDeferred;
+        return;
+    }
+
+    RenderCapture( s, inputTex, layout, region, w, h, hostFBO );
+    sf          = {};
+    sf.bandRows = bandRows;
+    sf.bands    = count;
+    sf.w        = w;
+    sf.h        = h;
+    sf.layout   = layout;
+    sf.captured = captured;
+
+    // The capture target is top-down, so band n is rows n * bandRows onwards
+    glBindFramebuffer( GL_READ_FRAMEBUFFER, s.captureFBO );
+    glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+    for( int band = 0; band < count; ++band )
+    {
+        const int      writeIdx = s.readback.Acquire();
+        const uint32_t row      = (uint32_t)band * bandRows;
+        const uint32_t rows     = std::min( bandRows, layout.targetH - row );
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, s.readback.Buffer( writeIdx ) );
+        glReadPixels( 0, (GLint)row, (GLsizei)layout.targetW, (GLsizei)rows,
+                      layout.readFormat, layout.readType, nullptr ); // nullptr = write to PBO
+        s.readback.Issue( writeIdx );
+        s.pending[ writeIdx ] = { sf.w, sf.h, sf.w, true, sf.layout, sf.captured, band };
+    }
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    glBindFramebuffer( GL_FRAMEBUFFER, hostFBO );
+    glFlush();   // start the transfers now, not when the host next flushes
+}
+
+// Copies a landed band (from PollNext) into the striped frame it belongs to,
+// passes the frame to the send thread once that was its last band, and
+// returns the slot to the ring.
+void OMTSend::HandOffBand( Stream& s, int readIdx )
+{
+    const PendingFrame& pf = s.pending[ readIdx ];
+    StripedFrame&       sf = s.striped;
+
+    // Bands of a frame that was dropped since are just recycled
+    const bool current = pf.band >= 0 && sf.bands > 0 && pf.captured == sf.captured;
+    const uint8_t* src = current ? s.readback.Map( readIdx ) : nullptr;
+    if( src )
+    {
+        // The first band to land opens the write slot; it stays open until
+        // the last one, as nothing else writes to this stream meanwhile
+        if( !sf.dst )
+            sf.dst = s.video.BeginWrite( sf.w, sf.h, sf.layout.stride, sf.layout.dataBytes, sf.captured );
+
+        // Packed bytes run on from one target row to the next, so a band is
+        // one contiguous range of the frame.  The target may be padded past
+        // the frame's end (odd plane heights): that part isn't sent.
+        const size_t rowBytes = (size_t)sf.layout.targetW * sf.layout.texelBytes;
+        const size_t offset   = (size_t)pf.band * sf.bandRows * rowBytes;
+        if( offset < sf.layout.dataBytes )
+            OMTRowCopy::Bytes( sf.dst + offset, src,
+                               std::min( (size_t)sf.bandRows * rowBytes, sf.layout.dataBytes - offset ) );
+        s.readback.Unmap( readIdx );
+
+        if( ++sf.landed == sf.bands )
+        {
+            s.video.CommitWrite( sf.layout.codec, sf.layout.colorSpace );
+            sf = {};
+        }
+    }
+    else if( current )
+        sf = {};   // couldn't map: the frame can't be completed
+    s.readback.Recycle( readIdx );
+}
+
+// Copies a landed readback slot to `dst` in the layout OMT expects.
+void OMTSend::CopyReadback( uint8_t* dst, const uint8_t* src, const PendingFrame& pf )
+{
+    if( pf.packed )
+    {
+        // Capture pass output: already top-down in the final layout, send as-is
+        OMTRowCopy::Bytes( dst, src, pf.layout.dataBytes );
+    }
+    else
+    {
+        // Flip rows: direct reads come back bottom-to-top, OMT expects top-to-bottom,
+        // so walk the source from its last row with a negative stride.
+        // This also handles the pitch != w padding case of a whole-texture read
+        // since we copy stride bytes from each source row (skipping any padding
+        // columns on the right).
+        const uint32_t  stride    = pf.layout.stride;
+        const ptrdiff_t srcStride = (ptrdiff_t)pf.pitch * 4;
+        OMTRowCopy::Rows( dst, stride, src + ( pf.h - 1 ) * srcStride, -srcStride,
+                          stride, pf.h );
+    }
+}
+
+// Stops handing the stream's readbacks to the readback thread, once the
+// ones it has are finished - from then on only the GL thread writes to the
+// stream's video buffer again.
+void OMTSend::DetachReadbackThread( Stream& s )
+{
+    if( !s.thread )
+        return;
+    s.thread->Flush( &s );
+    ReadbackThread::Release( s.thread );
+    s.thread = nullptr;
+}
+
+// Passes the newest frame of the stream's shared readback, if it hasn't
+// already, to the send thread - by reference, it is never copied again.
+void OMTSend::HandOffShared( Stream& s )
+{
+    ReadbackCache::Frame* f = ReadbackCache::Instance().Take( s.shared, s.sharedSeen,
+                                                              ReadbackScheduler::Instance().Frame() );
+    if( f )
+        s.video.WriteExternal( f->w, f->h, f->stride, f->codec, f->colorSpace,
+                               f->pixels.data(), f->pixels.size(), &f->refs, f->captured );
+}
+
+// Appends a stream whose video buffer wakes its send task.
+OMTSend::Stream& OMTSend::AddStream()
+{
+    mStreams.push_back( std::make_unique< Stream >() );
+    Stream& s = *mStreams.back();
+    s.sendTask.run = [ this, &s ]( SendExecutor::Clock::time_point now ) { return RunSendTask( s, now ); };
+    s.published.SetHandler( [ &s ] { SendExecutor::Instance().Notify( &s.sendTask ); } );
+    s.video.SetSignal( &s.published );
+    return s;
+}
+
+// Frees a stream's GL resources.  Only call while sending is stopped: the
+// video buffer may still reference the readback ring.
+void OMTSend::ReleaseStream( Stream& s )
+{
+    DetachReadbackThread( s );
+    s.video.Reset();  // drop references into the readback ring before freeing it
+    ReadbackCache::Instance().Detach( s.shared, &s );
+    ReadbackScheduler::Instance().Remove( &s );
+    s.shared     = nullptr;
+    s.sharedSeen = 0;
+    ReleaseCaptureTarget( s );
+    s.readback.Release();
+    s.pending.clear();
+    s.striped = {};
+}
+
+// Brings mStreams in line with the Tiles and Preview Stream params.
+// Adding, removing or renaming senders means restarting sending;
+// changing only a region or the preview size doesn't.
+void OMTSend::UpdateStreams( uint32_t inputW, uint32_t inputH )
+{
+    const size_t   tiles   = mTileCols ? (size_t)mTileCols * mTileRows : mTileRects.size();
+    const uint32_t preview = mCaptureReady ? PreviewScaleOption() : 0;
+    const size_t   count   = std::max< size_t >( tiles, 1 ) + ( preview > 0 ? 1 : 0 );
+
+    // Tiles, else the whole input, then the preview
+    const bool same = ( count == mStreams.size() ) &&
+                      ( tiles > 0 ) == !mStreams.front()->suffix.empty() &&
+                      ( preview > 0 ) == ( mStreams.back()->suffix == kPreviewSuffix );
+    if( !same )
+    {
+        const bool restart = mSending;
+        StopSending();
+        for( auto& s : mStreams )
+            ReleaseStream( *s );
+        mStreams.clear();
+        for( size_t i = 0; i < count; ++i )
+        {
+            Stream& s = AddStream();
+            if( i < tiles )
+                s.suffix = " (Tile " + std::to_string( i + 1 ) + ")";
+            else if( i > 0 )
+                s.suffix = kPreviewSuffix;
+        }
+        mDebugLogged = false;
+        if( restart )
+            StartSending();
+    }
+
+    for( size_t i = 0; i < tiles; ++i )
+    {
+        TileRect& t = mStreams[ i ]->rect;
+        if( mTileCols > 0 )
+        {
+            // Even grid; edges rounded so the tiles cover the input exactly
+            const uint32_t c = (uint32_t)( i % mTileCols ), r = (uint32_t)( i / mTileCols );
+            t.x = inputW * c / mTileCols;
+            t.y = inputH * r / mTileRows;
+            t.w = std::max( inputW * ( c + 1 ) / mTileCols - t.x, 1u );
+            t.h = std::max( inputH * ( r + 1 ) / mTileRows - t.y, 1u );
+        }
+        else
+            t = mTileRects[ i ];
+    }
+    if( tiles == 0 )
+    {
+        Stream& s = *mStreams.front();
+        s.filter = ScaleFilterOption();
+        OutputSizeOption( s.scale, s.fitW, s.fitH );
+        if( !mCaptureReady )
+        {
+            s.scale = 1;   // only the capture pass can scale
+            s.fitW  = s.fitH = 0;
+        }
+    }
+    if( preview > 0 )
+    {
+        Stream& s = *mStreams.back();
+        s.scale = preview;                  // area average, the Stream default
+        s.depth = kPreviewReadbackDepth;
+    }
+}
+
+OMTSend::DirectRead OMTSend::ChooseDirectRead( const FFGLTextureStruct& inputTex )
+{
+    if( GLEW_VERSION_4_5 || GLEW_ARB_get_texture_sub_image )
+        return DirectRead::SubImage;
+
+    // Attach the input to our read FBO so glReadPixels can take the visible
+    // region; some hosts' textures may not be attachable, hence the check
+    if( !mInputFBO )
+        glGenFramebuffers( 1, &mInputFBO );
+
+    GLint prevFBO = 0;
+    glGetIntegerv( GL_READ_FRAMEBUFFER_BINDING, &prevFBO );
+    glBindFramebuffer( GL_READ_FRAMEBUFFER, mInputFBO );
+    glFramebufferTexture2D( GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, inputTex.Handle, 0 );
+    const bool complete = glCheckFramebufferStatus( GL_READ_FRAMEBUFFER ) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer( GL_READ_FRAMEBUFFER, (GLuint)prevFBO );
+
+    return complete ? DirectRead::Framebuffer : DirectRead::WholeTexture;
+}
+
+bool OMTSend::EnsureCaptureTarget( Stream& s, uint32_t w, uint32_t h, GLenum internalFormat )
+{
+    if( s.captureFBO && w == s.captureW && h == s.captureH && internalFormat == s.captureFormat )
+        return true;
+
+    ReleaseCaptureTarget( s );
+
+    glGenTextures( 1, &s.captureTex );
+    glBindTexture( GL_TEXTURE_2D, s.captureTex );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST );
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST );
+    glTexImage2D( GL_TEXTURE_2D, 0, (GLint)internalFormat, (GLsizei)w, (GLsizei)h, 0,
+                  GL_BGRA, GL_UNSIGNED_BYTE, nullptr );
+    glBindTexture( GL_TEXTURE_2D, 0 );
+
+    GLint prevFBO = 0;
+    glGetIntegerv( GL_FRAMEBUFFER_BINDING, &prevFBO );
+    glGenFramebuffers( 1, &s.captureFBO );
+    glBindFramebuffer( GL_FRAMEBUFFER, s.captureFBO );
+    glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, s.captureTex, 0 );
+    const bool complete = glCheckFramebufferStatus( GL_FRAMEBUFFER ) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer( GL_FRAMEBUFFER, (GLuint)prevFBO );
+
+    if( !complete )
+    {
+        ReleaseCaptureTarget( s );
+        mCaptureReady = false;  // don't retry every frame; use the fallback path
+        return false;
+    }
+
+    s.captureW      = w;
+    s.captureH      = h;
+    s.captureFormat = internalFormat;
+    return true;
+}
+
+void OMTSend::ReleaseCaptureTarget( Stream& s )
+{
+    if( s.captureFBO ) { glDeleteFramebuffers( 1, &s.captureFBO ); s.captureFBO = 0; }
+    if( s.captureTex ) { glDeleteTextures( 1, &s.captureTex ); s.captureTex = 0; }
+    s.captureW = s.captureH = 0;
+    s.captureFormat = 0;
+}
+
+// Renders `region` of the input, resampled to w x h, into the stream's
+// capture target.
+void OMTSend::RenderCapture( Stream& s, const FFGLTextureStruct& inputTex, const PackLayout& layout,
+                             const TileRect& region, uint32_t w, uint32_t h, GLuint hostFBO )
+{
+    GLint viewport[ 4 ] = {};
+    glGetIntegerv( GL_VIEWPORT, viewport );
+
+    glBindFramebuffer( GL_FRAMEBUFFER, s.captureFBO );
+    glViewport( 0, 0, (GLsizei)s.captureW, (GLsizei)s.captureH );
+    {
+        ScopedShaderBinding shaderBinding( mCaptureShader.GetGLID() );
+        ScopedSamplerActivation sampler( 0 );
+        ScopedTextureBinding texBinding( GL_TEXTURE_2D, inputTex.Handle );
+
+        const bool bt601 = ( layout.colorSpace == OMTColorSpace_BT601 );
+        mCaptureShader.Set( "Size", (float)w, (float)h );
+        mCaptureShader.Set( "Origin", (float)region.x, (float)region.y );
+        mCaptureShader.Set( "Step", (float)region.w / w, (float)region.h / h );
+        mCaptureShader.Set( "Filter", (int)s.filter );
+        mCaptureShader.Set( "InputHeight", (int)inputTex.Height );
+        mCaptureShader.Set( "Format", (int)layout.format );
+        mCaptureShader.Set( "KrKb", bt601 ? 0.299f : 0.2126f, bt601 ? 0.114f : 0.0722f );
+        mCaptureShader.Set( "InputTexture", 0 );
+
+        glBindVertexArray( mVAO );
+        glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+        glBindVertexArray( 0 );
+    }
+    glBindFramebuffer( GL_FRAMEBUFFER, hostFBO );
+    glViewport( viewport[ 0 ], viewport[ 1 ], viewport[ 2 ], viewport[ 3 ] );
+}
+
+FFResult OMTSend::SetFloatParameter( unsigned int index, float value )
+{
+    if( index == PARAM_QUALITY )
+    {
+        mQuality = std::clamp( value, 0.0f, 1.0f );
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_FRAMERATE )
+    {
+        mFrameRateOption = value;
+        UpdateFrameRate( mFrameRateOption );
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_LOGGING )
+    {
+        mLoggingEnabled = ( value > 0.5f );
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_PIXEL_FORMAT )
+    {
+        mPixelFormatOption = value;
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_READBACK_DEPTH )
+    {
+        mReadbackDepthOption = value;
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_ZERO_COPY )
+    {
+        mZeroCopy = ( value > 0.5f );
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_SKIP_DUPLICATES )
+    {
+        mSkipDuplicates = ( value > 0.5f );
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_LOW_LATENCY )
+    {
+        mLowLatency = ( value > 0.5f );
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_ADAPTIVE_QUALITY )
+    {
+        mAdaptiveQuality = ( value > 0.5f );
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_TALLY_PRIORITY )
+    {
+        mTallyPriority = ( value > 0.5f );
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_PREVIEW )
+    {
+        mPreviewOption = value;   // applied by UpdateStreams() on the GL thread
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_OUTPUT_SIZE )
+    {
+        mOutputSizeOption = value;
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_SCALE_FILTER )
+    {
+        mScaleFilterOption = value;
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_SHARE_READBACK )
+    {
+        mShareReadback = ( value > 0.5f );
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_READBACK_BUDGET )
+    {
+        mReadbackBudgetOption = value;
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_READBACK_STRIPES )
+    {
+        mReadbackStripesOption = value;
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_READBACK_THREAD )
+    {
+        mReadbackThread = ( value > 0.5f );
+        return FF_SUCCESS;
+    }
+    return FF_FAIL;
+}
+
+float OMTSend::GetFloatParameter( unsigned int index )
+{
+    if( index == PARAM_QUALITY )   return mQuality;
+    if( index == PARAM_FRAMERATE ) return mFrameRateOption;
+    if( index == PARAM_LOGGING )   return mLoggingEnabled ? 1.0f : 0.0f;
+    if( index == PARAM_PIXEL_FORMAT ) return mPixelFormatOption;
+    if( index == PARAM_READBACK_DEPTH ) return mReadbackDepthOption;
+    if( index == PARAM_ZERO_COPY )      return mZeroCopy ? 1.0f : 0.0f;
+    if( index == PARAM_SKIP_DUPLICATES ) return mSkipDuplicates ? 1.0f : 0.0f;
+    if( index == PARAM_LOW_LATENCY )     return mLowLatency ? 1.0f : 0.0f;
+    if( index == PARAM_ADAPTIVE_QUALITY ) return mAdaptiveQuality ? 1.0f : 0.0f;
+    if( index == PARAM_TALLY_PRIORITY )   return mTallyPriority ? 1.0f : 0.0f;
+    if( index == PARAM_PREVIEW )          return mPreviewOption;
+    if( index == PARAM_OUTPUT_SIZE )      return mOutputSizeOption;
+    if( index == PARAM_SCALE_FILTER )     return mScaleFilterOption;
+    if( index == PARAM_SHARE_READBACK )   return mShareReadback ? 1.0f : 0.0f;
+    if( index == PARAM_READBACK_BUDGET )  return mReadbackBudgetOption;
+    if( index == PARAM_READBACK_STRIPES ) return mReadbackStripesOption;
+    if( index == PARAM_READBACK_THREAD )  return mReadbackThread ? 1.0f : 0.0f;
+    return 0.0f;
+}
+
+FFResult OMTSend::SetTextParameter( unsigned int index, const char* value )
+{
+    if( index == PARAM_SOURCE_NAME && value )
+    {
+        // Resolume sends "" on load before the user has set anything;
+        // treat that as "use the default" rather than blanking the name.
+        std::string newName = ( value[0] != '\0' ) ? value : "Resolume OMT";
+        if( mSourceName != newName )
+        {
+            mSourceName = newName;
+            // Restart sending so omt_send_create picks up the new name
+            if( mSending )
+            {
+                StopSending();
+                mDebugLogged = false;
+                StartSending();
+            }
+        }
+        return FF_SUCCESS;
+    }
+    if( index == PARAM_TILES && value )
+    {
+        // Applied by UpdateStreams() on the GL thread; an invalid entry
+        // turns tiling off rather than guessing
+        mTilesText = value;
+        ParseTiles( value, mTileCols, mTileRows, mTileRects );
+        return FF_SUCCESS;
+    }
+    return FF_FAIL;
+}
+
+char* OMTSend::GetTextParameter( unsigned int index )
+{
+    if( index == PARAM_SOURCE_NAME ) return const_cast< char* >( mSourceName.c_str() );
+    if( index == PARAM_TILES )       return const_cast< char* >( mTilesText.c_str() );
+    return nullptr;
+}
+
+
+
+// Registers every stream's send task with the SendExecutor; each opens its
+// sender on its first run, off the GL thread.
+void OMTSend::StartSending()
+{
+    if( mSending ) return;
+    mSending = true;
+
+    if( mDebugLogPath.empty() )
+    {
+        // Resolve the folder where our plugin DLL lives.
+        // Using FROM_ADDRESS on a local static ensures we get the plugin's own path,
+        // not libomt.dll which may be in a different directory.
+        std::wstring pluginDir;
+        {
+            static int sAnchor = 0;
+            wchar_t path[ MAX_PATH ] = {};
+            HMODULE hm = nullptr;
+            if( GetModuleHandleExW( GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                                    GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                    (LPCWSTR)&sAnchor, &hm ) )
+            {
+                GetModuleFileNameW( hm, path, MAX_PATH );
+                wchar_t* sl = wcsrchr( path, L'\\' );
+                if( sl ) pluginDir = std::wstring( path, sl + 1 );
+            }
+            if( pluginDir.empty() ) pluginDir = L".\\";
+        }
+        std::wstring vmxPath  = pluginDir + L"libvmx.dll";
+        std::wstring omtLog   = pluginDir + L"libomt_send.log";
+        mDebugLogPath         = pluginDir + L"omtsend_debug.txt";
+
+        // Pre-load libvmx.dll explicitly — .NET NativeAOT P/Invoke won't find it otherwise
+        HMODULE hvmx = LoadLibraryW( vmxPath.c_str() );
+        if( mLoggingEnabled )
+        {
+            std::ofstream dbg( mDebugLogPath, std::ios::app );
+            if( dbg )
+            {
+                dbg << "libvmx load: " << ( hvmx ? "OK" : "FAILED" )
+                    << " err=" << GetLastError() << "\n";
+            }
+        }
+
+        // Direct OMT's own log to the plugin folder (only if logging enabled)
+        if( mLoggingEnabled )
+        {
+            std::string omtLogA( omtLog.begin(), omtLog.end() );
+            omt_setloggingfilename( omtLogA.c_str() );
+        }
+    }
+
+    // Timestamps of every stream count from the same epoch, so frames
+    // rendered together carry the same time.
+    mSendEpoch = mLastStats = std::chrono::steady_clock::now();
+    for( auto& s : mStreams )
+    {
+        s->send = {};
+        s->send.name    = mSourceName + s->suffix;
+        s->send.quality = mAdaptiveQuality ? OMTQuality_Default : QualityEnum();
+        s->rateDivisor  = 1;
+        s->send.lastQualitySample = s->send.lastQualityChange = mSendEpoch;
+        SendExecutor::Instance().Add( &s->sendTask );
+    }
+}
+
+// Unregisters the send tasks (waiting for any that are running) and
+// destroys the senders.
+void OMTSend::StopSending()
+{
+    if( !mSending ) return;
+    mSending = false;
+
+    for( auto& s : mStreams )
+        SendExecutor::Instance().Remove( &s->sendTask );
+
+    for( auto& s : mStreams )
+    {
+        s->connections = -1;
+        s->tally       = TALLY_UNKNOWN;
+        if( s->sender )
+            omt_send_destroy( s->sender );
+        s->sender = nullptr;
+    }
+}
+
+// One run of a stream's send task: polls its sender for receivers, tally
+// and adaptive quality, and sends whatever the GL thread has published
+// since the last run.  Runs again when the next frame is published, or at
+// the returned time - soon enough to notice a receiver coming back within
+// about a frame, and a first one within kPollNeverConnected.
+std::chrono::steady_clock::time_point OMTSend::RunSendTask( Stream& s, std::chrono::steady_clock::time_point now )
+{
+    using Clock = std::chrono::steady_clock;
+    Stream::SendState& st = s.send;
+
+    // Also retries a sender that couldn't be created, or recreated at a
+    // new quality
+    if( !s.sender && now >= st.nextOpen && !OpenSender( s, st.quality ) )
+        st.nextOpen = now + kSenderRetryInterval;
+    if( s.sender )
+        PollSender( s, now );
+    if( &s == mStreams.front().get() )
+        LogSendStats( now );
+
+    // Send the newest frame, once its pacing allows.  A zero-copy frame's
+    // PBO goes back to the GL thread on the next read.
+    for( ;; )
+    {
+        if( !st.held )
+        {
+            const OMTVideoFrame* vf = s.video.TryRead();
+            if( !vf )
+                break;
+            if( !s.sender || !ScheduleFrame( s, vf, now ) )
+                continue;
+            st.held = vf;
+        }
+        if( st.release > Clock::now() )
+            return st.release;
+
+        SendFrame( s, st.held );
+        st.held = nullptr;
+    }
+
+    if( s.connections.load() > 0 )
+        return now + kPollConnected;
+    if( !st.everConnected )
+        return now + kPollNeverConnected;
+    const FrameRate rate = GetFrameRate();
+    return now + std::chrono::microseconds( 1000000ll * rate.d / std::max( 1, rate.n ) );
+}
+
+// Writes the instance's counters to the debug log every kStatsLogInterval.
+void OMTSend::LogSendStats( std::chrono::steady_clock::time_point now )
+{
+    if( !mLoggingEnabled || now - mLastStats < kStatsLogInterval )
+        return;
+    mLastStats = now;
+
+    std::ofstream dbg( mDebugLogPath, std::ios::app );
+    for( const auto& s : mStreams )
+    {
+        if( dbg ) dbg << "send stats" << s->suffix << ": sent=" << s->framesSent.load()
+                      << " skipped=" << s->framesSkipped.load()
+                      << " deferred=" << s->framesDeferred.load()
+                      << " connections=" << s->connections.load()
+                      << " latency=" << s->sendLatencyMs.load() << "ms"
+                      << ( mLowLatency ? " (low latency)" : "" ) << "\n";
+    }
+    const ReadbackScheduler& scheduler = ReadbackScheduler::Instance();
+    if( dbg ) dbg << "readback (all instances): last frame " << scheduler.LastFrameBytes() / 1024
+                  << " KB in " << scheduler.LastFrameMs() << "ms, deferred="
+                  << scheduler.Deferred() << "\n";
+}
+
+// Creates the stream's sender at `quality`, named after Source Name (as it
+// was when sending started) plus the stream's suffix.  A stream whose
+// sender can't be created reports no connections, so the GL thread stops
+// reading it back until a retry succeeds.
+bool OMTSend::OpenSender( Stream& s, OMTQuality quality )
+{
+    const std::string& name = s.send.name;
+    s.sender = omt_send_create( name.c_str(), quality );
+    if( !s.sender )
+    {
+        s.connections = 0;
+        if( mLoggingEnabled )
+        {
+            std::ofstream dbg( mDebugLogPath, std::ios::app );
+            if( dbg ) dbg << "omt_send_create FAILED for name='" << name << "'\n";
+        }
+        return false;
+    }
+
+    if( mLoggingEnabled )
+    {
+        char addr[1024] = {};
+        omt_send_getaddress( s.sender, addr, sizeof(addr) );
+        std::ofstream dbg( mDebugLogPath, std::ios::app );
+        if( dbg ) dbg << "omt_send_create OK, address='" << addr << "'\n";
+    }
+    return true;
+}
+
+// Publishes the stream's receiver count and tally for the GL thread, and
+// runs the adaptive quality controller.
+void OMTSend::PollSender( Stream& s, std::chrono::steady_clock::time_point now )
+{
+    Stream::SendState& st = s.send;
+
+    // The GL thread stops reading back frames while this is zero.  A new
+    // receiver must get the current picture even if it is static.
+    const int connections = omt_send_connections( s.sender );
+    if( connections > s.connections.exchange( connections ) )
+        st.haveLast = false;
+    if( connections > 0 )
+        st.everConnected = true;
+
+    // Tally across all receivers, for the GL thread's rate policy
+    OMTTally tally = {};
+    omt_send_gettally( s.sender, 0, &tally );
+    const Tally state = tally.program ? TALLY_PROGRAM : tally.preview ? TALLY_PREVIEW : TALLY_NONE;
+    if( s.tally.exchange( state ) != state && mLoggingEnabled )
+    {
+        std::ofstream dbg( mDebugLogPath, std::ios::app );
+        if( dbg ) dbg << "tally" << s.suffix << ": " << ( state == TALLY_PROGRAM ? "program" :
+                                                          state == TALLY_PREVIEW ? "preview" : "none" ) << "\n";
+    }
+
+    // The quality the sender should have: the Quality param, or with
+    // Adaptive Quality whatever the receivers suggest.  Changing it means a
+    // new sender, so only a change of either param does.
+    const OMTQuality wanted = mAdaptiveQuality ? OMTQuality_Default : QualityEnum();
+    if( wanted != st.quality )
+    {
+        omt_send_destroy( s.sender );
+        const bool ok = OpenSender( s, wanted );
+        if( mLoggingEnabled )
+        {
+            std::ofstream dbg( mDebugLogPath, std::ios::app );
+            if( dbg ) dbg << "sender" << s.suffix << " recreated at " << QualityName( wanted ) << " quality"
+                          << ( ok ? "" : " FAILED" ) << "\n";
+        }
+        st.quality     = wanted;
+        st.lastDropped = 0;
+        st.overloaded  = st.relaxed = 0;
+        st.haveLast    = false;   // new sender: resend even a static picture
+        if( !ok )
+        {
+            st.nextOpen = now + kSenderRetryInterval;
+            return;
+        }
+    }
+
+    // Adaptive Quality: halve the send rate while the encoder can't keep
+    // up, and restore it once it has had room to spare for a while
+    if( !mAdaptiveQuality )
+    {
+        s.rateDivisor = 1;
+        return;
+    }
+    if( connections <= 0 || now - st.lastQualitySample < kQualitySampleInterval )
+        return;
+    st.lastQualitySample = now;
+
+    // Overloaded: frames dropped, or the last encode took most of the
+    // frame budget.  Relaxed: comfortably inside it.
+    OMTStatistics stats = {};
+    omt_send_getvideostatistics( s.sender, &stats );
+    const int       divisor  = s.rateDivisor.load();
+    const FrameRate rate     = GetFrameRate();
+    const double    budgetMs = 1000.0 * rate.d * divisor / std::max( 1, rate.n );
+    const bool      dropped  = stats.FramesDropped > st.lastDropped;
+    st.lastDropped = stats.FramesDropped;
+
+    if( dropped || stats.CodecTimeSinceLast > budgetMs * 0.9 ) { ++st.overloaded; st.relaxed = 0; }
+    else if( stats.CodecTimeSinceLast < budgetMs * 0.5 )       { ++st.relaxed; st.overloaded = 0; }
+    else                                                       { st.overloaded = st.relaxed = 0; }
+
+    if( now - st.lastQualityChange < kQualityHoldTime )
+        return;
+    int next = divisor;
+    if( st.overloaded >= kQualityOverloadedSamples && divisor < kMaxRateDivisor )
+        next = divisor * 2;
+    else if( st.relaxed >= kQualityRelaxedSamples && divisor > 1 )
+        next = divisor / 2;
+    if( next == divisor )
+        return;
+
+    if( mLoggingEnabled )
+    {
+        std::ofstream dbg( mDebugLogPath, std::ios::app );
+        if( dbg ) dbg << "adaptive quality" << s.suffix << ": send rate 1/" << divisor << " -> 1/" << next
+                      << " (encode " << stats.CodecTimeSinceLast << "ms of " << budgetMs
+                      << "ms budget, dropped=" << stats.FramesDropped << ")\n";
+    }
+    s.rateDivisor        = next;
+    st.lastQualityChange = now;
+    st.overloaded        = st.relaxed = 0;
+}
+
+// Where the alpha in a frame starts: 0 for BGRA, and for UYVA / PA16 the
+// alpha plane after the colour plane(s) - one stride x height plane for
+// UYVY, Y plus CbCr for P216.  SIZE_MAX if the codec carries no alpha.
+static size_t AlphaOffset( const OMTVideoFrame& vf )
+{
+    switch( vf.codec )
+    {
+    case OMTCodec_BGRA: return 0;
+    case OMTCodec_UYVA: return (size_t)vf.stride * vf.height;
+    case OMTCodec_PA16: return (size_t)vf.stride * vf.height * 2;
+    default:            return SIZE_MAX;
+    }
+}
+
+// Decides what happens to a frame read from the stream's video buffer:
+// false if it repeats the last one sent (see Skip Duplicates), otherwise
+// sets send.release to when SendFrame() should hand it on.
+bool OMTSend::ScheduleFrame( Stream& s, const OMTVideoFrame* vf,
+                             std::chrono::steady_clock::time_point now )
+{
+    using Clock = std::chrono::steady_clock;
+    Stream::SendState& st = s.send;
+
+    // Skip frames identical to the last one sent.  The frame's geometry
+    // and codec seed the hash so a format change never looks identical.
+    // The hash reads the whole frame anyway, so it also works out SendFrame()'s
+    // alpha verdict on the way rather than that scanning it again.
+    st.heldOpaque = -1;
+    if( mSkipDuplicates )
+    {
+        const uint64_t seed = ( (uint64_t)vf->width << 48 ) ^ ( (uint64_t)vf->height << 32 ) ^
+                              ( (uint64_t)vf->stride << 16 ) ^ vf->codec;
+        const size_t   alpha = AlphaOffset( *vf );
+        uint64_t       hash;
+        if( alpha != SIZE_MAX && alpha % 4 == 0 )
+        {
+            uint32_t words;
+            hash = OMTFrameHash::Hash( vf->Data(), vf->DataBytes(), seed, alpha, words );
+            const uint32_t mask = ( vf->codec == OMTCodec_BGRA ) ? 0xFF000000u : 0xFFFFFFFFu;
+            st.heldOpaque = ( ( words & mask ) == mask ) ? 1 : 0;
+        }
+        else
+            hash = OMTFrameHash::Hash( vf->Data(), vf->DataBytes(), seed );
+        if( st.haveLast && hash == st.lastHash && now - st.lastSend < kDuplicateKeepAlive )
+        {
+            ++s.framesSkipped;
+            return false;
+        }
+        st.lastHash = hash;
+        st.haveLast = true;
+    }
+    else
+        st.haveLast = false;
+
+    // Frames are timestamped with when the GL thread rendered them, in OMT's
+    // 100 ns units counted from `epoch`, and released a fixed delay after
+    // that render time.  The wire then follows the host's render clock
+    // instead of readback/copy jitter or libomt's own pacing (which only
+    // applies to Timestamp = -1) beating against it.  The delay tracks how
+    // late frames typically reach this thread, plus headroom for its
+    // variation, so almost every frame is held rather than sent late.
+    // The send task holds the frame rather than sleeping on a worker.
+    st.release = now;
+    const bool stamped = ( vf->captured != OMTVideoFrame::Clock::time_point{} );
+    if( stamped && !mLowLatency )
+    {
+        const double ms = std::chrono::duration< double, std::milli >( now - vf->captured ).count();
+        st.arrivalDevMs += ( std::abs( ms - st.arrivalMs ) - st.arrivalDevMs ) / 16.0;
+        st.arrivalMs    += ( ms - st.arrivalMs ) / 16.0;
+
+        const auto delay = std::chrono::duration< double, std::milli >( st.arrivalMs + 2.0 * st.arrivalDevMs );
+        st.release = vf->captured + std::min( std::chrono::duration_cast< Clock::duration >( delay ),
+                                              std::chrono::duration_cast< Clock::duration >( kMaxPaceDelay ) );
+    }
+    return true;
+}
+
+// Hands a frame ScheduleFrame() accepted to the stream's sender.
+void OMTSend::SendFrame( Stream& s, const OMTVideoFrame* vf )
+{
+    using Clock = std::chrono::steady_clock;
+    Stream::SendState& st = s.send;
+    const Clock::time_point now = Clock::now();
+    const bool stamped = ( vf->captured != OMTVideoFrame::Clock::time_point{} );
+
+    // Strictly increasing, even across a frame captured before the sender
+    // was (re)created
+    int64_t timestamp = -1;
+    if( stamped )
+    {
+        timestamp = std::max< int64_t >( 0, std::chrono::duration_cast< std::chrono::nanoseconds >(
+                                                vf->captured - mSendEpoch ).count() / 100 );
+        timestamp = st.lastTimestamp = std::max( timestamp, st.lastTimestamp + 1 );
+    }
+
+    const FrameRate rate = GetFrameRate();
+    OMTMediaFrame frame = {};
+    frame.Type          = OMTFrameType_Video;
+    frame.Codec         = (OMTCodec)vf->codec;
+    frame.Width         = (int)vf->width;
+    frame.Height        = (int)vf->height;
+    frame.Stride        = (int)vf->stride;
+    frame.FrameRateN    = rate.n;
+    frame.FrameRateD    = rate.d;
+    frame.Timestamp     = timestamp;   // -1 (unstamped) = let libomt pace
+    frame.AspectRatio   = (float)vf->width / (float)vf->height;
+    frame.ColorSpace    = (OMTColorSpace)vf->colorSpace;
+    frame.Flags         = OMTVideoFlags_None;
+    frame.Data          = const_cast< uint8_t* >( vf->Data() );
+    frame.DataLength    = (int)vf->DataBytes();
+
+    // Alpha is only signalled while the content uses it.  Any translucent
+    // pixel turns it back on at once; it only goes off after a run of
+    // opaque frames, so a fade that briefly hits full opacity doesn't make
+    // receivers flip between encodes.
+    const bool planarAlpha = ( vf->codec == OMTCodec_UYVA || vf->codec == OMTCodec_PA16 );
+    if( vf->codec == OMTCodec_BGRA || planarAlpha )
+    {
+        // Scanned already if ScheduleFrame() hashed the frame
+        const size_t colorBytes = AlphaOffset( *vf );
+        const bool   opaque = ( st.heldOpaque >= 0 ) ? st.heldOpaque != 0
+            : ( vf->codec == OMTCodec_BGRA )
+            ? OMTAlphaScan::OpaqueBGRA( vf->Data(), vf->DataBytes() )
+            : OMTAlphaScan::OpaquePlane( vf->Data() + colorBytes, vf->DataBytes() - colorBytes );
+
+        st.opaqueFrames = opaque ? st.opaqueFrames + 1 : 0;
+        if( !opaque )
+            st.sendAlpha = true;
+        else if( st.opaqueFrames >= kOpaqueFramesBeforeNoAlpha )
+            st.sendAlpha = false;
+
+        if( st.sendAlpha )
+            frame.Flags = OMTVideoFlags_Alpha;
+        else if( planarAlpha )
+        {
+            // UYVY / P216 is the leading part; don't send the alpha at all
+            frame.Codec      = ( vf->codec == OMTCodec_PA16 ) ? OMTCodec_P216 : OMTCodec_UYVY;
+            frame.DataLength = (int)colorBytes;
+        }
+    }
+
+    if( frame.Codec == OMTCodec_P216 || frame.Codec == OMTCodec_PA16 )
+        frame.Flags = (OMTVideoFlags)( frame.Flags | OMTVideoFlags_HighBitDepth );
+
+    // Render -> omt_send latency, smoothed over roughly the last 16 frames
+    if( stamped )
+    {
+        const double ms   = std::chrono::duration< double, std::milli >( Clock::now() - vf->captured ).count();
+        const double prev = s.sendLatencyMs.load();
+        s.sendLatencyMs = ( prev > 0.0 ) ? prev + ( ms - prev ) / 16.0 : ms;
+    }
+
+    omt_send( s.sender, &frame );
+    st.lastSend = now;
+    ++s.framesSent;
+}
+
+OMTSend::PixelFormat OMTSend::PixelFormatOption() const
+{
+    const int idx = (int)( mPixelFormatOption + 0.5f );
+    return ( idx >= PIXFMT_BGRA && idx <= PIXFMT_PA16 ) ? (PixelFormat)idx : PIXFMT_BGRA;
+}
+
+int OMTSend::ReadbackDepthOption() const
+{
+    return std::clamp( (int)( mReadbackDepthOption + 0.5f ), 2, 6 );
+}
+
+uint32_t OMTSend::PreviewScaleOption() const
+{
+    switch( (int)( mPreviewOption + 0.5f ) )
+    {
+    case 1:  return 4;
+    case 2:  return 8;
+    default: return 0;   // off
+    }
+}
+
+void OMTSend::OutputSizeOption( uint32_t& scale, uint32_t& fitW, uint32_t& fitH ) const
+{
+    scale = 1;
+    fitW  = fitH = 0;
+    switch( (int)( mOutputSizeOption + 0.5f ) )
+    {
+    case 1:  fitW = 3840; fitH = 2160; break;
+    case 2:  fitW = 1920; fitH = 1080; break;
+    case 3:  fitW = 1280; fitH = 720;  break;
+    case 4:  scale = 2;                break;
+    case 5:  scale = 4;                break;
+    default:                           break;   // input size
+    }
+}
+
+double OMTSend::ReadbackBudgetMs() const
+{
+    switch( (int)( mReadbackBudgetOption + 0.5f ) )
+    {
+    case 1:  return 2.0;
+    case 2:  return 4.0;
+    case 3:  return 8.0;
+    default: return 0.0;   // unlimited
+    }
+}
+
+int OMTSend::ReadbackStripesOption() const
+{
+    switch( (int)( mReadbackStripesOption + 0.5f ) )
+    {
+    case 1:  return 2;
+    case 2:  return 4;
+    case 3:  return 8;
+    default: return 1;   // off: the whole frame at once
+    }
+}
+
+OMTSend::ScaleFilter OMTSend::ScaleFilterOption() const
+{
+    const int idx = (int)( mScaleFilterOption + 0.5f );
+    return ( idx >= FILTER_BILINEAR && idx <= FILTER_AREA ) ? (ScaleFilter)idx : FILTER_AREA;
+}
+
+double OMTSend::SendRateTarget() const
+{
+    // Adaptive Quality: every stream takes the same host frames, so the
+    // most overloaded encoder sets the rate for all of them
+    int divisor = 1;
+    for( const auto& s : mStreams )
+        divisor = std::max( divisor, s->rateDivisor.load() );
+
+    const FrameRate rate = GetFrameRate();
+    const double    fps  = (double)rate.n / (double)rate.d / divisor;
+    if( !mTallyPriority )
+        return fps;
+
+    // The highest tally of any sender decides: one tile on program keeps
+    // the whole wall at full rate
+    int tally = TALLY_NONE;
+    for( const auto& s : mStreams )
+        tally = ( s->tally.load() == TALLY_UNKNOWN ) ? TALLY_PROGRAM : std::max( tally, s->tally.load() );
+
+    switch( tally )
+    {
+    case TALLY_NONE:    return std::min( fps, kTallyIdleFps );
+    case TALLY_PREVIEW: return fps * kTallyPreviewRateScale;
+    default:            return fps;   // program, or not known yet
+    }
+}
+
+OMTQuality OMTSend::QualityEnum() const
+{
+    if( mQuality < 0.33f ) return OMTQuality_Low;
+    if( mQuality < 0.67f ) return OMTQuality_Medium;
+    return OMTQuality_High;
+}
+
+OMTSend::FrameRate OMTSend::GetFrameRate() const
+{
+    const uint64_t packed = mFrameRate.load();
+    return { (int)( packed >> 32 ), (int)( packed & 0xFFFFFFFFu ) };
+}
+
+void OMTSend::SetFrameRate( int n, int d )
+{
+    mFrameRate = ( (uint64_t)(uint32_t)n << 32 ) | (uint32_t)d;
 }
 
 void OMTSend::UpdateFrameRate( float optionValue )
 {
-    // optionValue is the element value set in SetParamElementInfo (0..4)
+    // optionValue is the element value set in SetParamElementInfo (0..6)
     int idx = (int)( optionValue + 0.5f );
+    mAutoFrameRate = ( idx == 6 );
+    if( mAutoFrameRate )
+        return;  // keeps the last rate until the host cadence is measured
+
     switch( idx )
     {
-    case 0:  mFrameRateN = 24;    mFrameRateD = 1;    break;  // 24 fps
-    case 1:  mFrameRateN = 25;    mFrameRateD = 1;    break;  // 25 fps
-    case 2:  mFrameRateN = 30000; mFrameRateD = 1001; break;  // 29.97 fps
-    case 3:  mFrameRateN = 30;    mFrameRateD = 1;    break;  // 30 fps
-    case 4:  mFrameRateN = 50;    mFrameRateD = 1;    break;  // 50 fps
-    default: mFrameRateN = 60;    mFrameRateD = 1;    break;  // 60 fps
+    case 0:  SetFrameRate( 24,    1 );    break;  // 24 fps
+    case 1:  SetFrameRate( 25,    1 );    break;  // 25 fps
+    case 2:  SetFrameRate( 30000, 1001 ); break;  // 29.97 fps
+    case 3:  SetFrameRate( 30,    1 );    break;  // 30 fps
+    case 4:  SetFrameRate( 50,    1 );    break;  // 50 fps
+    default: SetFrameRate( 60,    1 );    break;  // 60 fps
     }
 }
+
+void OMTSend::UpdateAutoFrameRate()
+{
+    // Standard rates the measured host cadence is snapped to
+    static const FrameRate kRates[] = {
+        { 24000, 1001 }, { 24, 1 }, { 25, 1 }, { 30000, 1001 }, { 30, 1 },
+        { 48, 1 }, { 50, 1 }, { 60000, 1001 }, { 60, 1 }, { 72, 1 }, { 75, 1 },
+        { 90, 1 }, { 100, 1 }, { 120000, 1001 }, { 120, 1 }, { 144, 1 }, { 240, 1 },
+    };
+
+    const double frameTime = mDecimator.HostFrameTime();
+    if( frameTime <= 0.0 )
+        return;
+    const double fps = 1.0 / frameTime;
+
+    // Hysteresis: keep the current rate while it is still within 1%, so a
+    // host hovering between 59.94 and 60 doesn't flip the advertised rate
+    const FrameRate rate    = GetFrameRate();
+    const double    current = (double)rate.n / (double)rate.d;
+    if( std::abs( fps - current ) <= current * 0.01 )
+        return;
+
+    FrameRate best  = { 0, 1 };
+    double    error = 0.0;
+    for( const FrameRate& r : kRates )
+    {
+        const double e = std::abs( fps - (double)r.n / r.d ) / fps;
+        if( best.n == 0 || e < error ) { best = r; error = e; }
+    }
+    if( error > 0.05 )
+        best = { std::max( 1, (int)( fps + 0.5 ) ), 1 };   // non-standard: nearest whole rate
+
+    SetFrameRate( best.n, best.d );
+}
@@ -7,6 +7,12 @@
 #include <ffglex/FFGLShader.h>
 
 #include "../shared/OMTVideoBuffer.h"
+#include "FrameDecimator.h"
+#include "ReadbackCache.h"
+#include "ReadbackRing.h"
+#include "ReadbackScheduler.h"
+#include "ReadbackThread.h"
+#include "SendExecutor.h"
 
 // These must be defined before libomt.h pulls in Windows.h
 #ifndef WIN32_LEAN_AND_MEAN
@@ -18,12 +24,56 @@
 #include <libomt.h>
 
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <string>
-#include <thread>
+#include <vector>
 
 class OMTSend : public CFFGLPlugin
 {
 public:
+    // Pixel formats selectable for the wire (values match the dropdown)
+    enum PixelFormat : int
+    {
+        PIXFMT_BGRA = 0,
+        PIXFMT_UYVY,
+        PIXFMT_UYVA,
+        PIXFMT_NV12,
+        PIXFMT_P216,
+        PIXFMT_PA16
+    };
+
+    // Resampling filters of the capture pass (values match the dropdown)
+    enum ScaleFilter : int
+    {
+        FILTER_BILINEAR = 0,
+        FILTER_BICUBIC,
+        FILTER_AREA
+    };
+
+    // How one frame is packed by the capture pass and described to OMT.
+    // targetW x targetH is the render target the packed bytes occupy
+    // (RGBA8, or RGBA16 for the 16-bit formats).
+    struct PackLayout
+    {
+        PixelFormat   format;
+        OMTCodec      codec;
+        OMTColorSpace colorSpace;
+        uint32_t      stride;      // bytes per row of the first plane
+        size_t        dataBytes;   // total bytes handed to omt_send
+        uint32_t      targetW, targetH;
+        GLenum        targetFormat; // internal format of the capture target
+        GLenum        readFormat;   // glReadPixels format/type for the target
+        GLenum        readType;
+        uint32_t      texelBytes;   // bytes per target texel in the readback
+    };
+
+    // A video wall tile: a region of the input in pixels, top-left origin
+    struct TileRect
+    {
+        uint32_t x, y, w, h;
+    };
+
     OMTSend();
     ~OMTSend() override;
 
@@ -42,31 +92,146 @@ private:
     GLuint             mVBO = 0;
     bool               mShaderReady = false;
 
-    OMTVideoBuffer     mVideoBuffer;
+    // GPU flip/crop pass feeding the readback (see kCaptureFragmentShader)
+    ffglex::FFGLShader mCaptureShader;
+    bool               mCaptureReady = false;
 
-    // PBO double-buffer for async GPU->CPU readback.
-    // Each frame we kick off a DMA transfer into mPBO[mPBOWriteIdx],
-    // then next frame we map mPBO[mPBOReadIdx] (transfer complete by then)
-    // and hand the pixels to the send thread without stalling the GL thread.
-    GLuint  mPBO[2] = { 0, 0 };
-    int     mPBOWriteIdx = 0;      // PBO we're writing to this frame
-    bool    mPBOReady = false;  // true once at least one frame has been kicked off
-    size_t  mPBOSize = 0;      // current allocation size in bytes
+    // How the fallback path (no capture pass) reads the input texture:
+    // the visible region via glGetTextureSubImage (GL 4.5) or glReadPixels
+    // from mInputFBO, or as a last resort the whole padded texture.
+    enum class DirectRead { SubImage, Framebuffer, WholeTexture };
+    GLuint             mInputFBO = 0;
 
-    // Dimensions of the frame currently in-flight in the read PBO
-    struct PendingFrame { uint32_t w, h, hw, stride; };
-    PendingFrame mPending = {};
+    // What each readback slot holds while its transfer is in flight.
+    // packed = came from the capture pass (top-down, final layout);
+    // otherwise it is a raw bottom-up BGRA read whose rows are `pitch`
+    // pixels apart (w, or the hardware width for a whole-texture read).
+    // captured = when the frame was rendered, for latency measurement.
+    // band = which band of a striped readback the slot holds (-1 = all of it).
+    struct PendingFrame
+    {
+        uint32_t w, h, pitch;
+        bool     packed;
+        PackLayout layout;
+        OMTVideoFrame::Clock::time_point captured;
+        int      band = -1;
+    };
 
-    // Crop buffer for when hw != w (padding columns need stripping)
-    std::vector<uint8_t> mCropBuf;
+    // The frame a striped readback (see Readback Stripes) is working on:
+    // its capture target is read back as `bands` bands of `bandRows` rows,
+    // and each landed band copied to `dst`, the video buffer's write slot.
+    // bands == 0 = none in progress.
+    struct StripedFrame
+    {
+        int        bands = 0, landed = 0;
+        uint32_t   bandRows = 0;
+        uint32_t   w = 0, h = 0;
+        PackLayout layout = {};
+        OMTVideoFrame::Clock::time_point captured = {};
+        uint8_t*   dst = nullptr;
+    };
 
-    bool mDebugLogged = false;
+    // Tally across all of a sender's receivers, polled by the send thread;
+    // with Tally Priority on, the GL thread lowers the readback rate off program.
+    enum Tally : int { TALLY_UNKNOWN = -1, TALLY_NONE, TALLY_PREVIEW, TALLY_PROGRAM };
 
-    std::thread        mSendThread;
-    std::atomic<bool>  mRunSendThread{ false };
-    void SendThreadFunc();
+    // One OMT sender and the path feeding it: the whole input (scaled to
+    // Output Size), or with Tiles set one sender per tile, then the optional
+    // preview stream (the whole input area-averaged down by `scale`).  The GL thread
+    // owns the capture target and the fenced PBO ring (see ReadbackRing.h);
+    // the stream's send task, run by the process-wide SendExecutor, owns the
+    // sender and `send` state - "the send thread" is whichever worker runs it.
+    struct Stream
+    {
+        std::string suffix;     // appended to Source Name for the sender
+        uint32_t    scale = 1;  // divides the source region, each way
+        uint32_t    fitW = 0, fitH = 0;   // then shrinks it to fit (0 = no limit)
+        ScaleFilter filter = FILTER_AREA;
+        int         depth = 0;  // readback ring slots; 0 = the Readback Buffers param
+        TileRect    rect = {};  // source region; 0 x 0 = the whole input
+
+        // GL thread
+        GLuint                    captureFBO = 0;
+        GLuint                    captureTex = 0;
+        uint32_t                  captureW = 0, captureH = 0;
+        GLenum                    captureFormat = 0;
+        ReadbackRing              readback;
+        std::vector<PendingFrame> pending;
+        StripedFrame              striped;
+        ReadbackThread*           thread = nullptr;   // finishing the readbacks, if Readback Thread
+
+        // Share Readback: the process-wide entry for what this stream reads
+        // back, whether this stream is the one producing it for others, and
+        // the newest shared frame already passed on
+        ReadbackCache::Entry*     shared = nullptr;
+        bool                      producing = false;
+        uint64_t                  sharedSeen = 0;
+
+        OMTVideoBuffer            video;
+        OMTFrameSignal            published;   // rung by `video`, notifies sendTask
+        SendExecutor::Task        sendTask;
+
+        // Receivers connected to the sender, published by the send thread.
+        // -1 = unknown (no sender yet), so the GL thread keeps reading back.
+        std::atomic<int>          connections{ -1 };
+        std::atomic<int>          tally{ TALLY_UNKNOWN };
+
+        // Frames handed to omt_send, repeats of the previous frame skipped
+        // instead (see Skip Duplicates), readbacks the GL budget deferred
+        // (see ReadbackScheduler), and the smoothed render -> omt_send
+        // latency in milliseconds
+        std::atomic<uint64_t>     framesSent{ 0 };
+        std::atomic<uint64_t>     framesSkipped{ 0 };
+        std::atomic<uint64_t>     framesDeferred{ 0 };
+        std::atomic<double>       sendLatencyMs{ 0.0 };
+
+        // Adaptive Quality: the send thread divides the send rate by this
+        // while the encoder is overloaded (see SendRateTarget)
+        std::atomic<int>          rateDivisor{ 1 };
+
+        // Send task only; reset each time sending starts
+        omt_send_t* sender = nullptr;
+        struct SendState
+        {
+            using Clock = std::chrono::steady_clock;
+
+            bool     sendAlpha    = true;   // see kOpaqueFramesBeforeNoAlpha
+            int      opaqueFrames = 0;
+            int      heldOpaque   = -1;     // alpha verdict from ScheduleFrame's hash, -1 = not scanned
+            uint64_t lastHash = 0;          // content hash of the last frame sent
+            bool     haveLast = false;
+            Clock::time_point lastSend;
+            int64_t  lastTimestamp = -1;
+            double   arrivalMs = 0.0, arrivalDevMs = 0.0;   // smoothed render -> read delay
+            std::string       name;         // sender name, fixed when sending starts
+            Clock::time_point nextOpen;     // earliest (re)try at creating the sender
+            bool              everConnected = false;   // any receiver since sending started
 
-    omt_send_t* mOMTSender = nullptr;
+            // A frame read from `video` but held back until `release` for
+            // pacing (see ScheduleFrame); newer frames wait in the buffer
+            const OMTVideoFrame* held = nullptr;
+            Clock::time_point    release;
+
+            // The sender's quality, and Adaptive Quality (see kQualitySampleInterval)
+            OMTQuality        quality = OMTQuality_Default;
+            int64_t           lastDropped = 0;
+            int               overloaded = 0, relaxed = 0;
+            Clock::time_point lastQualitySample, lastQualityChange;
+        } send;
+    };
+    std::vector< std::unique_ptr< Stream > > mStreams;
+
+    // Picks which host frames are read back for the selected frame rate
+    FrameDecimator            mDecimator;
+
+    bool mDebugLogged = false;
+
+    // Streams' send tasks are registered with the SendExecutor.  Their
+    // timestamps all count from mSendEpoch; the first stream's task also
+    // writes the instance's stats log.
+    bool               mSending = false;
+    std::chrono::steady_clock::time_point mSendEpoch, mLastStats;
+    std::wstring       mDebugLogPath;   // set when sending first starts
 
     enum ParamIndex : unsigned int
     {
@@ -74,20 +239,96 @@ private:
         PARAM_QUALITY,
         PARAM_FRAMERATE,
         PARAM_LOGGING,
+        PARAM_PIXEL_FORMAT,
+        PARAM_READBACK_DEPTH,
+        PARAM_ZERO_COPY,
+        PARAM_SKIP_DUPLICATES,
+        PARAM_LOW_LATENCY,
+        PARAM_ADAPTIVE_QUALITY,
+        PARAM_TALLY_PRIORITY,
+        PARAM_PREVIEW,
+        PARAM_TILES,
+        PARAM_OUTPUT_SIZE,
+        PARAM_SCALE_FILTER,
+        PARAM_SHARE_READBACK,
+        PARAM_READBACK_BUDGET,
+        PARAM_READBACK_STRIPES,
+        PARAM_READBACK_THREAD,
         PARAM_COUNT
     };
 
     std::string        mSourceName = "Resolume OMT";
-    float              mQuality = 0.5f;
+    std::atomic<float> mQuality{ 0.5f };            // unless Adaptive Quality
     float              mFrameRateOption = 5.0f;  // index into dropdown (5 = 60fps default)
     std::atomic<bool>  mLoggingEnabled{ false };
+    float              mPixelFormatOption = 0.0f;  // PixelFormat, read on the GL thread
+    float              mReadbackDepthOption = 3.0f; // ReadbackRing slots (2..6)
+    bool               mZeroCopy = false;           // persistent-mapped send, GL thread only
+    std::atomic<bool>  mSkipDuplicates{ true };     // read by the send thread
+    std::atomic<bool>  mLowLatency{ false };        // same-frame readback (see kLowLatencyWaitNs)
+    std::atomic<bool>  mAdaptiveQuality{ false };    // send thread steps quality on overload
+    std::atomic<bool>  mTallyPriority{ false };     // rate follows tally (see SendRateTarget)
+    float              mPreviewOption = 0.0f;       // preview stream size, read on the GL thread
+    float              mOutputSizeOption = 0.0f;    // whole-input stream size, GL thread
+    float              mScaleFilterOption = 2.0f;   // ScaleFilter for Output Size, GL thread
+    bool               mShareReadback = false;      // see ReadbackCache, GL thread only
+    float              mReadbackBudgetOption = 0.0f; // see ReadbackBudgetMs, GL thread
+    float              mReadbackStripesOption = 0.0f; // see ReadbackStriped, GL thread
+    bool               mReadbackThread = false;     // see ReadbackThread, GL thread only
+
+    // Tiles param as typed, and parsed: a cols x rows grid, or explicit
+    // rectangles (see ParseTiles); neither = tiling off
+    std::string           mTilesText;
+    uint32_t              mTileCols = 0, mTileRows = 0;
+    std::vector<TileRect> mTileRects;
+
+    // Decoded from dropdown, read by the send thread.  Numerator in the
+    // high and denominator in the low 32 bits of one atomic, so a reader
+    // never pairs the N of one rate with the D of another.
+    struct FrameRate { int n, d; };
+    std::atomic<uint64_t> mFrameRate{ ( 60ull << 32 ) | 1 };
+    bool               mAutoFrameRate = false;  // follow the host cadence (GL thread)
 
-    // Decoded from dropdown, read atomically by send thread
-    std::atomic<int>   mFrameRateN{ 60 };
-    std::atomic<int>   mFrameRateD{ 1 };
+    bool       EnsureCaptureTarget(Stream& s, uint32_t w, uint32_t h, GLenum internalFormat);
+    void       ReleaseCaptureTarget(Stream& s);
+    void       RenderCapture(Stream& s, const FFGLTextureStruct& inputTex, const PackLayout& layout,
+                             const TileRect& region, uint32_t w, uint32_t h, GLuint hostFBO);
+    void       ReadbackStream(Stream& s, const FFGLTextureStruct& inputTex, GLuint hostFBO,
+                              bool frameDue, OMTVideoFrame::Clock::time_point captured);
+    void       ReadbackStriped(Stream& s, const FFGLTextureStruct& inputTex, const PackLayout& layout,
+                               const TileRect& region, uint32_t w, uint32_t h, int bands,
+                               GLuint hostFBO, bool frameDue, OMTVideoFrame::Clock::time_point captured);
+    void       HandOffReadback(Stream& s, int readIdx);
+    void       HandOffBand(Stream& s, int readIdx);
+    void       HandOffShared(Stream& s);
+    static void CopyReadback(uint8_t* dst, const uint8_t* src, const PendingFrame& pf);
+    void       DetachReadbackThread(Stream& s);
+    Stream&    AddStream();
+    void       ReleaseStream(Stream& s);
+    void       UpdateStreams(uint32_t inputW, uint32_t inputH);
+    DirectRead ChooseDirectRead(const FFGLTextureStruct& inputTex);
 
-    void       StartSendThread();
-    void       StopSendThread();
+    void       StartSending();
+    void       StopSending();
+    std::chrono::steady_clock::time_point
+               RunSendTask(Stream& s, std::chrono::steady_clock::time_point now);
+    void       LogSendStats(std::chrono::steady_clock::time_point now);
+    bool       OpenSender(Stream& s, OMTQuality quality);
+    void       PollSender(Stream& s, std::chrono::steady_clock::time_point now);
+    bool       ScheduleFrame(Stream& s, const OMTVideoFrame* vf,
+                             std::chrono::steady_clock::time_point now);
+    void       SendFrame(Stream& s, const OMTVideoFrame* vf);
+    PixelFormat PixelFormatOption() const;
+    int        ReadbackDepthOption() const;
+    uint32_t   PreviewScaleOption() const;
+    void       OutputSizeOption(uint32_t& scale, uint32_t& fitW, uint32_t& fitH) const;
+    ScaleFilter ScaleFilterOption() const;
+    double     ReadbackBudgetMs() const;
+    int        ReadbackStripesOption() const;
+    double     SendRateTarget() const;
     OMTQuality QualityEnum() const;
+    FrameRate  GetFrameRate() const;
+    void       SetFrameRate(int n, int d);
     void       UpdateFrameRate(float sliderValue);
+    void       UpdateAutoFrameRate();
 };
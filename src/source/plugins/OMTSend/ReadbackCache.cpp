@@ -0,0 +1,171 @@
+#include "ReadbackCache.h"
+
+#include <algorithm>
+
+// Most frames one entry keeps: the newest, plus those still being sent
+static const size_t kMaxFrames = 8;
+
+struct ReadbackCache::Entry
+{
+    Key               key;
+    int               users = 0;
+    const void*       owner = nullptr;
+    uint64_t          claimed = 0;   // host frame of the owner's last claim
+
+    // Heap-allocated so readers' reference counters keep a stable address
+    std::vector< std::unique_ptr< Frame > > frames;
+    Frame*            latest     = nullptr;
+    uint64_t          nextSerial = 1;
+};
+
+bool ReadbackCache::Key::operator==( const Key& o ) const
+{
+    return context == o.context && texture == o.texture &&
+           x == o.x && y == o.y && w == o.w && h == o.h &&
+           outW == o.outW && outH == o.outH && codec == o.codec && filter == o.filter;
+}
+
+ReadbackCache& ReadbackCache::Instance()
+{
+    static ReadbackCache sCache;
+    return sCache;
+}
+
+ReadbackCache::Entry* ReadbackCache::Attach( Entry* current, const Key& key, const void* who )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    if( current && current->key == key )
+        return current;
+
+    if( current )
+    {
+        --current->users;
+        if( current->owner == who )
+            current->owner = nullptr;
+    }
+    Prune();
+
+    auto it = std::find_if( mEntries.begin(), mEntries.end(),
+                            [ & ]( const std::unique_ptr< Entry >& e ) { return e->key == key; } );
+    if( it == mEntries.end() )
+    {
+        mEntries.push_back( std::make_unique< Entry >() );
+        mEntries.back()->key = key;
+        it = mEntries.end() - 1;
+    }
+    ++( *it )->users;
+    return it->get();
+}
+
+void ReadbackCache::Detach( Entry* entry, const void* who )
+{
+    if( !entry )
+        return;
+
+    std::lock_guard< std::mutex > lock( mMutex );
+    --entry->users;
+    if( entry->owner == who )
+        entry->owner = nullptr;
+    Prune();
+}
+
+int ReadbackCache::Users( const Entry* entry )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    return entry->users;
+}
+
+// A frame from this host frame or the one before
+static bool Recent( uint64_t stamp, uint64_t hostFrame )
+{
+    return stamp == hostFrame || stamp + 1 == hostFrame;
+}
+
+bool ReadbackCache::Claim( Entry* entry, const void* who, uint64_t hostFrame )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    if( entry->owner != who && entry->owner && Recent( entry->claimed, hostFrame ) )
+        return false;
+
+    entry->owner   = who;
+    entry->claimed = hostFrame;
+    return true;
+}
+
+void ReadbackCache::Yield( Entry* entry, const void* who )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    if( entry->owner == who )
+        entry->owner = nullptr;
+}
+
+ReadbackCache::Frame* ReadbackCache::Acquire( Entry* entry, size_t bytes )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+
+    Frame* frame = nullptr;
+    for( auto& f : entry->frames )
+    {
+        if( f.get() != entry->latest && f->refs.load( std::memory_order_acquire ) == 0 )
+        {
+            frame = f.get();
+            break;
+        }
+    }
+    if( !frame )
+    {
+        if( entry->frames.size() >= kMaxFrames )
+            return nullptr;
+        entry->frames.push_back( std::make_unique< Frame >() );
+        frame = entry->frames.back().get();
+    }
+    frame->pixels.resize( bytes );
+    return frame;
+}
+
+void ReadbackCache::Publish( Entry* entry, Frame* frame, uint64_t hostFrame )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    frame->serial    = entry->nextSerial++;
+    frame->hostFrame = hostFrame;
+    frame->refs.store( 1 );   // the entry's hold, until a newer frame replaces it
+    if( entry->latest )
+        entry->latest->refs.fetch_sub( 1, std::memory_order_release );
+    entry->latest = frame;
+}
+
+ReadbackCache::Frame* ReadbackCache::Take( Entry* entry, uint64_t& seen, uint64_t hostFrame )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    Frame* frame = entry->latest;
+    if( !frame || frame->serial <= seen || !Recent( frame->hostFrame, hostFrame ) )
+        return nullptr;
+
+    seen = frame->serial;
+    frame->refs.fetch_add( 1 );
+    return frame;
+}
+
+// Frees entries nobody is attached to once no sender reads their frames.
+// Called with mMutex held.
+void ReadbackCache::Prune()
+{
+    for( auto it = mEntries.begin(); it != mEntries.end(); )
+    {
+        Entry& e = **it;
+        if( e.users > 0 )
+        {
+            ++it;
+            continue;
+        }
+
+        if( e.latest )
+        {
+            e.latest->refs.fetch_sub( 1, std::memory_order_release );
+            e.latest = nullptr;
+        }
+        const bool idle = std::all_of( e.frames.begin(), e.frames.end(),
+            []( const std::unique_ptr< Frame >& f ) { return f->refs.load( std::memory_order_acquire ) == 0; } );
+        it = idle ? mEntries.erase( it ) : it + 1;
+    }
+}
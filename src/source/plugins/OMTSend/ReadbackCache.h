@@ -0,0 +1,102 @@
+#pragma once
+
+#include <FFGLSDK.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// ReadbackCache
+//
+// Process-wide registry that lets OMTSend instances reading back the same
+// texture the same way (region, size, packing) share a single transfer.
+// Per key, one attached stream - the producer - keeps doing its readback
+// and publishes each landed frame as a ref-counted CPU copy; every other
+// attached stream skips its capture pass and readback and hands those
+// frames to its own sender without copying them again.
+//
+// Claims and frames are stamped with the host frame (ReadbackScheduler::
+// Frame()) they were made in.  The producer re-claims the key on every
+// frame it reads back, and another stream takes over once a whole host
+// frame has gone by without a claim (the producer was removed, bypassed,
+// or has nobody to send to).  Streams only pass on frames published in
+// this host frame or the one before - the producer may come after them in
+// the host's call order - never one left over from an earlier producer.
+//
+// Called from the GL thread; an internal mutex serialises instances that
+// render on different threads.  Frame::refs is decremented by send threads.
+// ---------------------------------------------------------------------------
+
+class ReadbackCache
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // What a stream reads back; streams share only if every field matches
+    struct Key
+    {
+        const void* context;        // GL context: texture names are per share group
+        GLuint      texture;
+        uint32_t    x, y, w, h;     // source region
+        uint32_t    outW, outH;     // delivered size
+        uint32_t    codec;
+        int         filter;
+
+        bool operator==( const Key& o ) const;
+    };
+
+    // A landed frame in its final (OMT) layout
+    struct Frame
+    {
+        std::vector<uint8_t> pixels;
+        uint32_t          w = 0, h = 0, stride = 0;
+        uint32_t          codec = 0, colorSpace = 0;
+        Clock::time_point captured = {};
+        uint64_t          serial = 0;
+        uint64_t          hostFrame = 0;   // published in
+        std::atomic<int>  refs{ 0 };   // readers, plus the entry's hold on its newest frame
+    };
+
+    struct Entry;
+
+    static ReadbackCache& Instance();
+
+    // Attaches `who` to the entry for `key`, leaving `current` if that is a
+    // different one.  Returns the entry now attached (== current if unchanged).
+    Entry* Attach( Entry* current, const Key& key, const void* who );
+    void   Detach( Entry* entry, const void* who );
+
+    // Streams attached to the entry; with only one there is nothing to share.
+    int    Users( const Entry* entry );
+
+    // True if `who` should do the readback for the entry in host frame
+    // `hostFrame`.  Takes the entry over if it has no producer, or the
+    // producer hasn't claimed it in this host frame or the one before.
+    bool   Claim( Entry* entry, const void* who, uint64_t hostFrame );
+
+    // Stops producing for the entry (e.g. no receivers), so another stream can.
+    void   Yield( Entry* entry, const void* who );
+
+    // Producer: a frame of `bytes` to fill, or nullptr if every frame is
+    // still being read; Publish() makes it the entry's newest, stamped with
+    // host frame `hostFrame`.
+    Frame* Acquire( Entry* entry, size_t bytes );
+    void   Publish( Entry* entry, Frame* frame, uint64_t hostFrame );
+
+    // The newest frame published after `seen` (which is updated), in host
+    // frame `hostFrame` or the one before, with a reference taken for the
+    // caller, or nullptr if there is none.
+    Frame* Take( Entry* entry, uint64_t& seen, uint64_t hostFrame );
+
+private:
+    ReadbackCache() = default;
+    void Prune();
+
+    std::mutex                              mMutex;
+    std::vector< std::unique_ptr< Entry > > mEntries;
+};
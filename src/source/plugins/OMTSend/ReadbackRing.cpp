@@ -0,0 +1,259 @@
+#include "ReadbackRing.h"
+
+static const GLbitfield kPersistentFlags =
+    GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+bool ReadbackRing::PersistentSupported()
+{
+    return GLEW_ARB_buffer_storage;
+}
+
+bool ReadbackRing::Configure( int depth, size_t bytesPerSlot, bool persistent )
+{
+    persistent = persistent && PersistentSupported();
+    if( depth == (int)mSlots.size() && bytesPerSlot == mSlotBytes && persistent == mPersistent )
+        return false;
+
+    // Keep anything another thread is still reading; drop the rest
+    for( auto& s : mSlots )
+    {
+        if( s->state == State::Lent && s->refs.load() > 0 )
+            mRetired.push_back( std::move( s ) );
+        else
+            Destroy( *s );
+    }
+    mSlots.clear();
+
+    mSlotBytes  = bytesPerSlot;
+    mPersistent = persistent;
+    for( int i = 0; i < depth; ++i )
+    {
+        auto s = std::make_unique<Slot>();
+        glGenBuffers( 1, &s->pbo );
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, s->pbo );
+        if( persistent )
+        {
+            // Immutable storage, mapped once for the life of the buffer.
+            // Coherent, so a signalled fence is all it takes for the CPU to
+            // see the transfer.
+            glBufferStorage( GL_PIXEL_PACK_BUFFER, (GLsizeiptr)bytesPerSlot, nullptr, kPersistentFlags );
+            s->mapped = reinterpret_cast< const uint8_t* >(
+                glMapBufferRange( GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)bytesPerSlot, kPersistentFlags ) );
+        }
+        else
+        {
+            glBufferData( GL_PIXEL_PACK_BUFFER, (GLsizeiptr)bytesPerSlot, nullptr, GL_STREAM_READ );
+        }
+        mSlots.push_back( std::move( s ) );
+    }
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    return true;
+}
+
+void ReadbackRing::Release()
+{
+    for( auto& s : mSlots )   Destroy( *s );
+    for( auto& s : mRetired ) Destroy( *s );
+    mSlots.clear();
+    mRetired.clear();
+    mSlotBytes  = 0;
+    mPersistent = false;
+}
+
+void ReadbackRing::Destroy( Slot& s )
+{
+    if( s.fence ) { glDeleteSync( s.fence ); s.fence = nullptr; }
+    if( s.pbo )
+    {
+        if( s.mapped )
+        {
+            glBindBuffer( GL_PIXEL_PACK_BUFFER, s.pbo );
+            glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+            glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+            s.mapped = nullptr;
+        }
+        glDeleteBuffers( 1, &s.pbo );
+        s.pbo = 0;
+    }
+}
+
+void ReadbackRing::CollectRetired()
+{
+    for( size_t i = 0; i < mRetired.size(); )
+    {
+        if( mRetired[ i ]->refs.load() == 0 )
+        {
+            Destroy( *mRetired[ i ] );
+            mRetired.erase( mRetired.begin() + i );
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+int ReadbackRing::OldestInFlight() const
+{
+    int oldest = -1;
+    for( int i = 0; i < (int)mSlots.size(); ++i )
+    {
+        const Slot& s = *mSlots[ i ];
+        if( s.state == State::InFlight && ( oldest < 0 || s.serial < mSlots[ oldest ]->serial ) )
+            oldest = i;
+    }
+    return oldest;
+}
+
+int ReadbackRing::PollReady()
+{
+    if( !mRetired.empty() )
+        CollectRetired();
+
+    int newest = -1;
+
+    // Transfers complete in issue order, so walk oldest-first and stop at
+    // the first one still pending.
+    for( int slot = OldestInFlight(); slot >= 0; slot = OldestInFlight() )
+    {
+        Slot& s = *mSlots[ slot ];
+
+        // Zero timeout: just ask.  The flush bit makes sure the fence is
+        // actually submitted so it can signal without us calling glFlush.
+        const GLenum r = glClientWaitSync( s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0 );
+        if( r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED )
+            break;
+
+        glDeleteSync( s.fence );
+        s.fence = nullptr;
+        s.state = State::Landed;
+
+        if( newest >= 0 )
+            Recycle( newest );   // superseded by a newer completed frame
+        newest = slot;
+    }
+    return newest;
+}
+
+int ReadbackRing::PollNext()
+{
+    if( !mRetired.empty() )
+        CollectRetired();
+
+    const int slot = OldestInFlight();
+    if( slot < 0 )
+        return -1;
+
+    Slot& s = *mSlots[ slot ];
+    const GLenum r = glClientWaitSync( s.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0 );
+    if( r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED )
+        return -1;
+
+    glDeleteSync( s.fence );
+    s.fence = nullptr;
+    s.state = State::Landed;
+    return slot;
+}
+
+int ReadbackRing::WaitReady( uint64_t timeoutNs )
+{
+    // Transfers complete in issue order, so the newest one finishing means
+    // everything before it has too
+    int newest = -1;
+    for( int i = 0; i < (int)mSlots.size(); ++i )
+    {
+        const Slot& s = *mSlots[ i ];
+        if( s.state == State::InFlight && ( newest < 0 || s.serial > mSlots[ newest ]->serial ) )
+            newest = i;
+    }
+    if( newest >= 0 )
+        glClientWaitSync( mSlots[ newest ]->fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs );
+
+    return PollReady();
+}
+
+int ReadbackRing::Acquire()
+{
+    for( int i = 0; i < (int)mSlots.size(); ++i )
+    {
+        Slot& s = *mSlots[ i ];
+        if( s.state == State::Lent && s.refs.load( std::memory_order_acquire ) == 0 )
+            s.state = State::Free;   // borrower is done with it
+        if( s.state == State::Free )
+            return i;
+    }
+    return -1;
+}
+
+int ReadbackRing::Available()
+{
+    int count = 0;
+    for( auto& slot : mSlots )
+    {
+        Slot& s = *slot;
+        if( s.state == State::Lent && s.refs.load( std::memory_order_acquire ) == 0 )
+            s.state = State::Free;
+        if( s.state == State::Free )
+            ++count;
+    }
+    return count;
+}
+
+void ReadbackRing::Issue( int slot )
+{
+    Slot& s  = *mSlots[ slot ];
+    s.fence  = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+    s.serial = mNextSerial++;
+    s.state  = State::InFlight;
+}
+
+const uint8_t* ReadbackRing::Map( int slot )
+{
+    Slot& s = *mSlots[ slot ];
+    if( s.mapped )
+        return s.mapped;
+
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, s.pbo );
+    const uint8_t* pixels = reinterpret_cast< const uint8_t* >(
+        glMapBufferRange( GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)mSlotBytes, GL_MAP_READ_BIT ) );
+
+    // Failed: callers skip Unmap(), so don't leave our buffer bound as the
+    // host's pack buffer - its next glReadPixels would land in it
+    if( !pixels )
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    return pixels;
+}
+
+void ReadbackRing::Unmap( int slot )
+{
+    Slot& s = *mSlots[ slot ];
+    if( s.mapped )
+        return;
+
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, s.pbo );
+    glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+}
+
+void ReadbackRing::Recycle( int slot )
+{
+    Slot& s = *mSlots[ slot ];
+    if( s.fence ) { glDeleteSync( s.fence ); s.fence = nullptr; }
+    s.state = State::Free;
+}
+
+std::atomic<int>* ReadbackRing::HandOver( int slot, GLsync& fence )
+{
+    Slot& s = *mSlots[ slot ];
+    fence   = s.fence;
+    s.fence = nullptr;   // the borrower deletes it
+    return Lend( slot );
+}
+
+std::atomic<int>* ReadbackRing::Lend( int slot )
+{
+    Slot& s = *mSlots[ slot ];
+    s.refs.store( 1, std::memory_order_relaxed );
+    s.state = State::Lent;
+    return &s.refs;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <FFGLSDK.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// ReadbackRing
+//
+// A ring of pixel-pack buffers for async GPU->CPU readback.  Each slot gets a
+// glFenceSync when its transfer is issued, and is only handed back for
+// mapping once that fence has signalled - so glMapBuffer never has to wait
+// for a DMA still in flight.
+//
+// Typical use, once per host frame on the GL thread:
+//
+//   int ready = ring.PollReady();          // newest finished transfer, or -1
+//   if( ready >= 0 ) { Map / consume / Unmap / Recycle( ready ) }
+//
+//   int slot = ring.Acquire();             // free slot, or -1 if all in flight
+//   if( slot >= 0 ) { bind Buffer( slot ), issue readback, Issue( slot ) }
+//
+// A deeper ring tolerates a slower GPU (more frames may be in flight before
+// Acquire() runs dry) at the cost of up to one frame of latency per slot.
+//
+// Persistent rings (GL_ARB_buffer_storage) keep every buffer mapped for its
+// whole life.  A landed slot can then be Lend()-ed to another thread, which
+// reads the mapped memory directly and decrements the returned counter when
+// done; the slot only goes back into rotation once that count hits zero.
+// ---------------------------------------------------------------------------
+
+class ReadbackRing
+{
+public:
+    ReadbackRing() = default;
+    ~ReadbackRing() = default;   // GL objects must be freed with Release() on the GL thread
+    ReadbackRing( const ReadbackRing& ) = delete;
+    ReadbackRing& operator=( const ReadbackRing& ) = delete;
+
+    // True if the driver can create persistent, coherent read mappings.
+    static bool PersistentSupported();
+
+    // (Re)creates the ring if the depth, per-slot size or mapping mode
+    // changed.  Anything in flight at the old configuration is discarded;
+    // slots still lent out are kept alive until they are returned.
+    // Returns true if the ring was rebuilt.
+    bool Configure( int depth, size_t bytesPerSlot, bool persistent = false );
+
+    // Frees every buffer and fence, including slots still lent out - the
+    // caller must make sure nothing reads them any more.  Call from DeInitGL.
+    void Release();
+
+    // Finds the newest slot whose transfer has completed without blocking.
+    // Older completed slots are recycled, since a newer frame supersedes them.
+    // Returns -1 if nothing has landed yet.
+    int PollReady();
+
+    // Like PollReady(), but first blocks for up to `timeoutNs` for the most
+    // recently issued transfer to finish.  For latency-critical callers
+    // willing to stall the GL thread on the frame they just read back.
+    int WaitReady( uint64_t timeoutNs );
+
+    // Like PollReady(), but returns the oldest completed transfer and leaves
+    // newer ones for later calls - for callers that need every transfer,
+    // not just the newest (striped readback).  Returns -1 if none has landed.
+    int PollNext();
+
+    // Returns a slot that is free to receive a new transfer, or -1 if every
+    // slot is still in flight or lent out (the caller should skip this frame).
+    int Acquire();
+
+    // How many slots Acquire() could hand out right now, for callers that
+    // issue several transfers together (striped readback).
+    int Available();
+
+    // Marks `slot` as in flight: fences the readback just recorded into it.
+    void Issue( int slot );
+
+    // Maps a slot returned by PollReady().  Unmap() before Recycle().
+    // Persistent slots are always mapped, so these cost nothing.  On
+    // failure returns nullptr with no pack buffer bound; skip Unmap().
+    const uint8_t* Map( int slot );
+    void           Unmap( int slot );
+
+    // Returns a consumed (or abandoned) slot to the free pool.
+    void Recycle( int slot );
+
+    // Persistent rings only: hands a landed slot's mapped memory to another
+    // thread.  The slot stays out of rotation until the returned counter is
+    // decremented to zero (from any thread).
+    std::atomic<int>* Lend( int slot );
+
+    // Hands a slot straight after Issue(), fence and all, to a thread with a
+    // context in the same share group (see ReadbackThread), which waits on
+    // `fence`, maps the buffer itself and deletes the fence.  Like Lend(),
+    // the slot stays out of rotation until the counter is decremented.
+    std::atomic<int>* HandOver( int slot, GLsync& fence );
+
+    GLuint Buffer( int slot ) const { return mSlots[ slot ]->pbo; }
+    int    Depth() const            { return (int)mSlots.size(); }
+    size_t SlotBytes() const        { return mSlotBytes; }
+    bool   Persistent() const       { return mPersistent; }
+
+private:
+    enum class State { Free, InFlight, Landed, Lent };
+
+    struct Slot
+    {
+        GLuint           pbo    = 0;
+        GLsync           fence  = nullptr;
+        uint64_t         serial = 0;        // issue order, for oldest-first polling
+        State            state  = State::Free;
+        const uint8_t*   mapped = nullptr;  // persistent mapping, if any
+        std::atomic<int> refs{ 0 };         // outstanding Lend()s
+    };
+
+    int  OldestInFlight() const;
+    static void Destroy( Slot& s );
+    void CollectRetired();
+
+    // Slots are heap-allocated so lent counters keep a stable address
+    std::vector< std::unique_ptr<Slot> > mSlots;
+    std::vector< std::unique_ptr<Slot> > mRetired;   // lent out when the ring was rebuilt
+    size_t   mSlotBytes  = 0;
+    bool     mPersistent = false;
+    uint64_t mNextSerial = 1;
+};
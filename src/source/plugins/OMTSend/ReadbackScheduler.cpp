@@ -0,0 +1,124 @@
+#include "ReadbackScheduler.h"
+
+#include <algorithm>
+
+// A frame whose leader hasn't come round again within this is over anyway
+// (the leader was bypassed or removed)
+static const auto kFrameTimeout = std::chrono::milliseconds( 100 );
+
+// EMA weight of a stream's newest measured cost
+static const double kCostSmoothing = 0.1;
+
+ReadbackScheduler& ReadbackScheduler::Instance()
+{
+    static ReadbackScheduler sScheduler;
+    return sScheduler;
+}
+
+void ReadbackScheduler::Begin( const void* who, double budgetMs, Clock::time_point now )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    Find( who ).budgetMs = budgetMs;
+    if( !mLeader || who == mLeader || now - mFrameStart > kFrameTimeout )
+        NextFrame( who, now );
+}
+
+bool ReadbackScheduler::Request( const void* who, size_t bytes, bool program )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    Participant& p = Find( who );
+    p.requested = true;
+
+    bool grant = program || mBudgetMs <= 0.0;
+    if( !grant )
+    {
+        // Hold back what the streams that have waited longer, and haven't
+        // had their turn yet this frame, are expected to need.  With none
+        // of those about, the frame's first readback goes ahead regardless,
+        // so a budget smaller than one readback still makes progress.
+        double reserved = 0.0;
+        bool   owed     = false;
+        for( const Participant& q : mParticipants )
+        {
+            if( q.who != who && !q.done && q.waiting > p.waiting )
+            {
+                reserved += q.costMs;
+                owed      = true;
+            }
+        }
+        grant = ( mSpentMs + reserved + p.costMs <= mBudgetMs ) || ( mGrants == 0 && !owed );
+    }
+
+    if( grant )
+    {
+        p.granted = true;
+        p.waiting = 0;
+        ++mGrants;
+        mBytes += bytes;
+    }
+    else
+    {
+        ++p.waiting;
+        ++mDeferred;
+    }
+    return grant;
+}
+
+void ReadbackScheduler::End( const void* who, double ms )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    Participant& p = Find( who );
+    p.done    = true;
+    mSpentMs += ms;
+
+    if( p.granted )
+        p.costMs = ( p.costMs > 0.0 ) ? p.costMs + kCostSmoothing * ( ms - p.costMs ) : ms;
+    if( !p.requested )
+        p.waiting = 0;   // nothing to read back (decimated, no receivers): not owed a turn
+}
+
+void ReadbackScheduler::Remove( const void* who )
+{
+    std::lock_guard< std::mutex > lock( mMutex );
+    mParticipants.erase( std::remove_if( mParticipants.begin(), mParticipants.end(),
+                                         [ who ]( const Participant& p ) { return p.who == who; } ),
+                         mParticipants.end() );
+    if( mLeader == who )
+        mLeader = nullptr;
+}
+
+// Called with mMutex held.
+ReadbackScheduler::Participant& ReadbackScheduler::Find( const void* who )
+{
+    for( Participant& p : mParticipants )
+        if( p.who == who )
+            return p;
+
+    mParticipants.push_back( Participant{ who } );
+    return mParticipants.back();
+}
+
+// Closes the current frame and opens the next, led by `leader`.
+// Called with mMutex held.
+void ReadbackScheduler::NextFrame( const void* leader, Clock::time_point now )
+{
+    if( mLeader )
+    {
+        mLastBytes = mBytes;
+        mLastMs    = mSpentMs;
+    }
+
+    ++mFrame;
+    mLeader     = leader;
+    mFrameStart = now;
+    mSpentMs    = 0.0;
+    mBytes      = 0;
+    mGrants     = 0;
+    mBudgetMs   = 0.0;
+    for( Participant& p : mParticipants )
+    {
+        if( p.budgetMs > 0.0 && ( mBudgetMs <= 0.0 || p.budgetMs < mBudgetMs ) )
+            mBudgetMs = p.budgetMs;
+        p.granted = p.requested = p.done = false;
+    }
+}
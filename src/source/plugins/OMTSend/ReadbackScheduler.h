@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// ReadbackScheduler
+//
+// Process-wide budget for the GL thread time every OMTSend stream in the DLL
+// spends per host frame issuing readbacks and mapping / copying the ones
+// that landed.  Once this frame's budget is used up, further readbacks are
+// deferred to a later frame instead of piling onto this one.
+//
+// Host frames are told apart without a counter from the host: the first
+// stream to Begin() a frame leads it, and the next frame starts when the
+// leader comes round again (or after a timeout, if it stops being called).
+// Frame() numbers them, for ReadbackCache.
+//
+// Fairness: a stream deferred in earlier frames ranks ahead of streams that
+// weren't, by how long it has waited, and budget is held back for it - so
+// streams late in the host's call order aren't starved by earlier ones.
+// Streams on program tally are never deferred, and every frame grants at
+// least one readback, so the budget only ever spreads work out.
+//
+// Call from the GL thread(s); send threads may read the counters.
+// ---------------------------------------------------------------------------
+
+class ReadbackScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static ReadbackScheduler& Instance();
+
+    // A stream is about to process a host frame; `budgetMs` is the budget
+    // it asks for (0 = unlimited; the smallest asked for applies).
+    void Begin( const void* who, double budgetMs, Clock::time_point now );
+
+    // True if `who` may issue a readback of `bytes` this frame.
+    bool Request( const void* who, size_t bytes, bool program );
+
+    // GL thread time `who` spent on this frame (readback plus hand-off).
+    void End( const void* who, double ms );
+
+    // Forgets a stream, e.g. when it is released.
+    void Remove( const void* who );
+
+    // The current host frame's number, counting up from 1.
+    uint64_t Frame() const { return mFrame.load(); }
+
+    // Counters of the last complete host frame, and the running total of
+    // deferred readbacks, for logging
+    size_t   LastFrameBytes() const { return mLastBytes.load(); }
+    double   LastFrameMs() const    { return mLastMs.load(); }
+    uint64_t Deferred() const       { return mDeferred.load(); }
+
+private:
+    ReadbackScheduler() = default;
+
+    struct Participant
+    {
+        const void* who;
+        double budgetMs  = 0.0;
+        double costMs    = 0.0;    // smoothed cost of a frame it read back
+        int    waiting   = 0;      // frames deferred in a row
+        bool   requested = false;  // this frame: Request() called,
+        bool   granted   = false;  //   and granted,
+        bool   done      = false;  //   End() called
+    };
+
+    Participant& Find( const void* who );
+    void         NextFrame( const void* leader, Clock::time_point now );
+
+    std::mutex                 mMutex;
+    std::vector< Participant > mParticipants;
+    const void*                mLeader = nullptr;
+    Clock::time_point          mFrameStart = {};
+    double                     mBudgetMs = 0.0;   // this frame's
+    double                     mSpentMs  = 0.0;
+    size_t                     mBytes    = 0;
+    int                        mGrants   = 0;
+
+    std::atomic<uint64_t>      mFrame{ 0 };
+    std::atomic<size_t>        mLastBytes{ 0 };
+    std::atomic<double>        mLastMs{ 0.0 };
+    std::atomic<uint64_t>      mDeferred{ 0 };
+};
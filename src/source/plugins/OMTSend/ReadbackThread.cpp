@@ -0,0 +1,187 @@
+#include "ReadbackThread.h"
+
+#include <GL/wglew.h>
+
+#include <algorithm>
+
+// How long the thread waits for a transfer before giving up on it
+static const GLuint64 kFenceTimeoutNs = 100000000;   // 100 ms
+
+std::mutex                                       ReadbackThread::sRegistryMutex;
+std::vector< std::unique_ptr< ReadbackThread > > ReadbackThread::sThreads;
+
+ReadbackThread* ReadbackThread::Acquire()
+{
+    const void* host = wglGetCurrentContext();
+    if( !host )
+        return nullptr;
+
+    std::lock_guard< std::mutex > lock( sRegistryMutex );
+    auto it = std::find_if( sThreads.begin(), sThreads.end(),
+                            [ host ]( const std::unique_ptr< ReadbackThread >& t ) { return t->mHostContext == host; } );
+    if( it == sThreads.end() )
+    {
+        // Kept even if it can't start, so later calls fail without retrying
+        std::unique_ptr< ReadbackThread > t( new ReadbackThread() );
+        t->mHostContext = host;
+        t->mFailed      = !t->Start();
+        sThreads.push_back( std::move( t ) );
+        it = sThreads.end() - 1;
+    }
+    if( ( *it )->Failed() )
+        return nullptr;
+    ++( *it )->mUsers;
+    return it->get();
+}
+
+void ReadbackThread::Release( ReadbackThread* thread )
+{
+    if( !thread )
+        return;
+
+    std::lock_guard< std::mutex > lock( sRegistryMutex );
+    thread->DeleteOrphanedFences();
+    if( --thread->mUsers > 0 )
+        return;
+
+    thread->Stop();
+    thread->DeleteOrphanedFences();
+
+    // A thread that failed stays registered, stopped, so Acquire() keeps
+    // refusing this context instead of creating a new one every other frame
+    if( thread->Failed() )
+        return;
+    sThreads.erase( std::find_if( sThreads.begin(), sThreads.end(),
+                                  [ thread ]( const std::unique_ptr< ReadbackThread >& t ) { return t.get() == thread; } ) );
+}
+
+void ReadbackThread::Submit( const void* owner, GLsync fence, GLuint pbo, size_t bytes,
+                             std::atomic<int>* refs, Consume consume )
+{
+    DeleteOrphanedFences();
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        mJobs.push_back( Job{ owner, fence, pbo, bytes, refs, std::move( consume ) } );
+    }
+    mQueued.notify_one();
+}
+
+void ReadbackThread::Flush( const void* owner )
+{
+    std::unique_lock< std::mutex > lock( mMutex );
+    mFinished.wait( lock, [ & ] {
+        return mBusy != owner &&
+               std::none_of( mJobs.begin(), mJobs.end(), [ owner ]( const Job& j ) { return j.owner == owner; } );
+    } );
+}
+
+// Deletes the fences of transfers the thread couldn't finish for lack of a
+// context.  Called on the GL thread - sync objects are shared, so the host
+// context can delete them.
+void ReadbackThread::DeleteOrphanedFences()
+{
+    std::vector< GLsync > fences;
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        fences.swap( mOrphanedFences );
+    }
+    for( GLsync fence : fences )
+        glDeleteSync( fence );
+}
+
+// Creates our context, sharing objects with the current one and asking for
+// the same version and profile, and starts the thread on it.  Called on the
+// GL thread, with the host context current.
+bool ReadbackThread::Start()
+{
+    if( !WGLEW_ARB_create_context )
+        return false;
+
+    GLint major = 0, minor = 0, profile = 0;
+    glGetIntegerv( GL_MAJOR_VERSION, &major );
+    glGetIntegerv( GL_MINOR_VERSION, &minor );
+    glGetIntegerv( GL_CONTEXT_PROFILE_MASK, &profile );
+    const int attribs[] = {
+        WGL_CONTEXT_MAJOR_VERSION_ARB, major,
+        WGL_CONTEXT_MINOR_VERSION_ARB, minor,
+        WGL_CONTEXT_PROFILE_MASK_ARB,  ( profile & GL_CONTEXT_CORE_PROFILE_BIT )
+                                           ? WGL_CONTEXT_CORE_PROFILE_BIT_ARB
+                                           : WGL_CONTEXT_COMPATIBILITY_PROFILE_BIT_ARB,
+        0
+    };
+
+    // The thread draws nothing, so the host's device context will do
+    mDC      = wglGetCurrentDC();
+    mContext = wglCreateContextAttribsARB( mDC, (HGLRC)mHostContext, attribs );
+    if( !mContext )
+        return false;
+
+    mThread = std::thread( &ReadbackThread::ThreadFunc, this );
+    return true;
+}
+
+// Finishes what is queued, then stops the thread and frees its context.
+void ReadbackThread::Stop()
+{
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        mStop = true;
+    }
+    mQueued.notify_one();
+    if( mThread.joinable() )
+        mThread.join();
+}
+
+void ReadbackThread::ThreadFunc()
+{
+    const bool current = wglMakeCurrent( mDC, mContext ) != 0;
+    mFailed = !current;
+
+    std::unique_lock< std::mutex > lock( mMutex );
+    for( ;; )
+    {
+        mQueued.wait( lock, [ this ] { return mStop || !mJobs.empty(); } );
+        if( mJobs.empty() )
+            break;   // stopping, and nothing left to finish
+
+        Job job = std::move( mJobs.front() );
+        mJobs.pop_front();
+        mBusy = job.owner;
+        lock.unlock();
+
+        // The GL thread flushed the fence, so it signals without our help
+        if( current )
+        {
+            const GLenum r = glClientWaitSync( job.fence, 0, kFenceTimeoutNs );
+            if( r == GL_ALREADY_SIGNALED || r == GL_CONDITION_SATISFIED )
+            {
+                glBindBuffer( GL_PIXEL_PACK_BUFFER, job.pbo );
+                const uint8_t* pixels = reinterpret_cast< const uint8_t* >(
+                    glMapBufferRange( GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)job.bytes, GL_MAP_READ_BIT ) );
+                if( pixels )
+                {
+                    job.consume( pixels );
+                    glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+                }
+                glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+            }
+            glDeleteSync( job.fence );
+
+            // Make the unmap reach the server before the GL thread can
+            // reuse the buffer from its own context
+            glFlush();
+        }
+        job.refs->fetch_sub( 1, std::memory_order_release );
+
+        lock.lock();
+        if( !current )
+            mOrphanedFences.push_back( job.fence );
+        mBusy = nullptr;
+        mFinished.notify_all();
+    }
+    lock.unlock();
+
+    if( current )
+        wglMakeCurrent( nullptr, nullptr );
+    wglDeleteContext( mContext );
+}
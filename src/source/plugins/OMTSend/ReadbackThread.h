@@ -0,0 +1,96 @@
+#pragma once
+
+#include <FFGLSDK.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// ReadbackThread
+//
+// A background thread with its own GL context, shared with the host's, that
+// finishes readbacks the GL thread has only issued: it waits on each
+// transfer's fence, maps the pixel-pack buffer, hands the pixels to a
+// callback (which repacks them for the sender) and unmaps it again.  The
+// host's render thread is left with recording the transfer and its fence.
+//
+// There is one thread per host context, shared by every stream of every
+// instance rendering on it, created by the first Acquire() and stopped
+// with the last Release().  Transfers are finished in submission order.
+//
+// Acquire / Release / Submit are called from the GL thread.
+// ---------------------------------------------------------------------------
+
+class ReadbackThread
+{
+public:
+    // Called on the readback thread with the mapped contents of a transfer
+    using Consume = std::function< void( const uint8_t* pixels ) >;
+
+    // The thread for the calling thread's current GL context, started on
+    // first use, or nullptr if no shared context can be created (callers
+    // then finish their readbacks themselves).  Balance with Release().
+    static ReadbackThread* Acquire();
+    static void            Release( ReadbackThread* thread );
+
+    // Queues the transfer recorded into `pbo` (`bytes` long) and fenced with
+    // `fence`, which the thread takes over.  The caller must have flushed
+    // the fence to the GPU.  `refs` is decremented once the buffer is unmapped
+    // again, whether or not the transfer landed in time to be consumed.
+    void Submit( const void* owner, GLsync fence, GLuint pbo, size_t bytes,
+                 std::atomic<int>* refs, Consume consume );
+
+    // Waits until every transfer `owner` submitted has been finished.
+    void Flush( const void* owner );
+
+    // True if the thread couldn't make its context current: nothing it is
+    // given is consumed, so callers should Release() it and fall back.
+    // Acquire() then returns nullptr for this context from then on.
+    bool Failed() const { return mFailed.load(); }
+
+    ReadbackThread( const ReadbackThread& ) = delete;
+    ReadbackThread& operator=( const ReadbackThread& ) = delete;
+
+private:
+    struct Job
+    {
+        const void*       owner;
+        GLsync            fence;
+        GLuint            pbo;
+        size_t            bytes;
+        std::atomic<int>* refs;
+        Consume           consume;
+    };
+
+    ReadbackThread() = default;
+    bool Start();
+    void Stop();
+    void ThreadFunc();
+    void DeleteOrphanedFences();
+
+    const void*       mHostContext = nullptr;
+    HDC               mDC          = nullptr;
+    HGLRC             mContext     = nullptr;   // ours, shared with mHostContext
+    int               mUsers       = 0;
+    std::atomic<bool> mFailed{ false };
+
+    std::thread             mThread;
+    std::mutex              mMutex;
+    std::condition_variable mQueued;      // a job was submitted, or stop requested
+    std::condition_variable mFinished;    // a job was finished
+    std::deque< Job >       mJobs;
+    const void*             mBusy = nullptr;   // owner of the job being finished
+    std::vector< GLsync >   mOrphanedFences;   // left for the GL thread to delete
+    bool                    mStop = false;
+
+    static std::mutex                                       sRegistryMutex;
+    static std::vector< std::unique_ptr< ReadbackThread > > sThreads;
+};
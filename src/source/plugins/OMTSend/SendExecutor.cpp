@@ -0,0 +1,111 @@
+#include "SendExecutor.h"
+
+#include <algorithm>
+
+// Upper bound on the pool, whatever the core count
+static const unsigned kMaxWorkers = 16;
+
+SendExecutor& SendExecutor::Instance()
+{
+    static SendExecutor sExecutor;
+    return sExecutor;
+}
+
+void SendExecutor::Add( Task* task )
+{
+    std::lock_guard< std::mutex > pool( mPoolMutex );
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        task->due      = Clock::time_point{};
+        task->notified = false;
+        task->running  = false;
+        mTasks.push_back( task );
+    }
+
+    if( mWorkers.empty() )
+    {
+        const unsigned count = std::clamp( std::thread::hardware_concurrency(), 1u, kMaxWorkers );
+        for( unsigned i = 0; i < count; ++i )
+            mWorkers.emplace_back( &SendExecutor::WorkerFunc, this );
+    }
+    mWake.notify_one();
+}
+
+void SendExecutor::Remove( Task* task )
+{
+    std::lock_guard< std::mutex > pool( mPoolMutex );
+    {
+        std::unique_lock< std::mutex > lock( mMutex );
+        const auto it = std::find( mTasks.begin(), mTasks.end(), task );
+        if( it == mTasks.end() )
+            return;
+        mTasks.erase( it );
+        mIdle.wait( lock, [ task ] { return !task->running; } );
+
+        if( !mTasks.empty() )
+            return;
+        mStop = true;
+    }
+
+    mWake.notify_all();
+    for( std::thread& t : mWorkers )
+        t.join();
+    mWorkers.clear();
+
+    std::lock_guard< std::mutex > lock( mMutex );
+    mStop = false;
+}
+
+void SendExecutor::Notify( Task* task )
+{
+    {
+        std::lock_guard< std::mutex > lock( mMutex );
+        task->notified = true;
+    }
+    mWake.notify_one();
+}
+
+void SendExecutor::WorkerFunc()
+{
+    std::unique_lock< std::mutex > lock( mMutex );
+    while( !mStop )
+    {
+        // The first task that is due, starting after the last one picked so
+        // a busy task can't keep the others waiting
+        const Clock::time_point now = Clock::now();
+        Clock::time_point wake = Clock::time_point::max();
+        Task* task = nullptr;
+        for( size_t i = 0; i < mTasks.size(); ++i )
+        {
+            const size_t idx = ( mNext + i ) % mTasks.size();
+            Task* t = mTasks[ idx ];
+            if( t->running )
+                continue;
+            if( t->notified || t->due <= now )
+            {
+                task  = t;
+                mNext = idx + 1;
+                break;
+            }
+            wake = std::min( wake, t->due );
+        }
+
+        if( !task )
+        {
+            if( wake == Clock::time_point::max() )
+                mWake.wait( lock );
+            else
+                mWake.wait_until( lock, wake );
+            continue;
+        }
+
+        task->running  = true;
+        task->notified = false;
+        lock.unlock();
+        const Clock::time_point due = task->run( now );
+        lock.lock();
+        task->running = false;
+        task->due     = due;
+        mIdle.notify_all();
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// SendExecutor
+//
+// Process-wide pool of worker threads, one per core, that runs the send
+// side of every OMTSend stream in the DLL - instead of a thread per plugin
+// instance.  Each stream registers a Task; a worker runs it when the GL
+// thread Notify()-s it about a new frame, or when the time the task last
+// asked for comes round (to poll its sender for receivers and tally).
+// A task never runs on two workers at once, but different tasks do, so
+// encoding spreads over the cores.  Between runs a task costs no thread -
+// only the timed wake-ups it asks for, so idle tasks should ask for few.
+//
+// The workers only exist while some task is registered.
+// ---------------------------------------------------------------------------
+
+class SendExecutor
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Task
+    {
+        // Does the task's work and returns when it next wants to run if it
+        // isn't notified before (Clock::time_point::max() = only then)
+        std::function< Clock::time_point( Clock::time_point now ) > run;
+
+    private:
+        friend class SendExecutor;
+        Clock::time_point due      = {};
+        bool              notified = false;
+        bool              running  = false;
+    };
+
+    static SendExecutor& Instance();
+
+    // Registers `task`, which runs straight away.  Starts the workers if
+    // they aren't running.
+    void Add( Task* task );
+
+    // Unregisters `task`, waiting for a run in progress to finish, so it can
+    // then be freed.  Stops the workers with the last task.  Never call
+    // from a task.
+    void Remove( Task* task );
+
+    // Runs `task` as soon as a worker is free, or again straight after the
+    // run in progress.  Callable from any thread.
+    void Notify( Task* task );
+
+private:
+    SendExecutor() = default;
+    void WorkerFunc();
+
+    std::mutex                 mPoolMutex;   // serialises starting / stopping the workers
+    std::vector< std::thread > mWorkers;
+
+    std::mutex                 mMutex;       // everything below, and every Task's state
+    std::condition_variable    mWake;        // a task may be due
+    std::condition_variable    mIdle;        // a run finished
+    std::vector< Task* >       mTasks;
+    size_t                     mNext = 0;    // where the next scan starts, for round robin
+    bool                       mStop = false;
+};
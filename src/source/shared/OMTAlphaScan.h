@@ -0,0 +1,150 @@
+#pragma once
+
+#include "OMTRowCopy.h"   // ISA detection and target attributes
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// OMTAlphaScan
+//
+// Tells whether a frame actually uses its alpha channel, so opaque frames
+// can go out without OMTVideoFlags_Alpha (and without UYVA's alpha plane).
+//
+// The scan ANDs the frame together a block at a time with the widest vector
+// unit available and bails out at the first block containing a
+// non-opaque alpha value, so translucent frames usually cost a few cache
+// lines and opaque ones a single streaming pass over memory.
+// ---------------------------------------------------------------------------
+
+class OMTAlphaScan
+{
+public:
+    // BGRA pixels: true if every 4th byte (alpha) is 255.
+    static bool OpaqueBGRA( const uint8_t* data, size_t bytes )
+    {
+        return AllSet( data, bytes, 0xFF000000u );
+    }
+
+    // An 8-bit alpha plane (e.g. UYVA's): true if every byte is 255.
+    static bool OpaquePlane( const uint8_t* data, size_t bytes )
+    {
+        return AllSet( data, bytes, 0xFFFFFFFFu );
+    }
+
+private:
+    static constexpr size_t kBlockBytes = 4u << 10;   // early-out granularity
+
+    // True if (word & mask) == mask for every little-endian 32-bit word of
+    // data; a trailing partial word is checked against the matching bytes
+    // of the mask.
+    static bool AllSet( const uint8_t* data, size_t bytes, uint32_t mask )
+    {
+        bool ( *block )( const uint8_t*, size_t, uint32_t ) = &BlockScalar;
+        switch( OMTRowCopy::BestIsa() )
+        {
+#if defined( OMT_ROWCOPY_X86 )
+        case OMTRowCopy::Isa::AVX512:
+        case OMTRowCopy::Isa::AVX2:   block = &BlockAVX2; break;
+        case OMTRowCopy::Isa::SSE2:   block = &BlockSSE2; break;
+#elif defined( OMT_ROWCOPY_NEON )
+        case OMTRowCopy::Isa::NEON:   block = &BlockNEON; break;
+#endif
+        default: break;
+        }
+
+        const size_t words = bytes & ~size_t( 3 );
+        for( size_t i = 0; i < words; i += kBlockBytes )
+        {
+            const size_t n = ( words - i < kBlockBytes ) ? words - i : kBlockBytes;
+            if( !block( data + i, n, mask ) )
+                return false;
+        }
+        for( size_t i = words; i < bytes; ++i )
+        {
+            const uint8_t m = uint8_t( mask >> ( 8 * ( i & 3 ) ) );
+            if( ( data[ i ] & m ) != m )
+                return false;
+        }
+        return true;
+    }
+
+    // Every kernel takes a multiple of 4 bytes
+    static bool BlockScalar( const uint8_t* data, size_t n, uint32_t mask )
+    {
+        uint32_t acc = 0xFFFFFFFFu;
+        for( size_t i = 0; i < n; i += 4 )
+        {
+            uint32_t w;
+            std::memcpy( &w, data + i, 4 );
+            acc &= w;
+        }
+        return ( acc & mask ) == mask;
+    }
+
+#if defined( OMT_ROWCOPY_X86 )
+    static bool BlockSSE2( const uint8_t* data, size_t n, uint32_t mask )
+    {
+        __m128i acc = _mm_set1_epi32( -1 );
+        size_t  i   = 0;
+        for( ; i + 64 <= n; i += 64 )
+        {
+            const __m128i a = _mm_loadu_si128( (const __m128i*)( data + i ) );
+            const __m128i b = _mm_loadu_si128( (const __m128i*)( data + i + 16 ) );
+            const __m128i c = _mm_loadu_si128( (const __m128i*)( data + i + 32 ) );
+            const __m128i d = _mm_loadu_si128( (const __m128i*)( data + i + 48 ) );
+            acc = _mm_and_si128( acc, _mm_and_si128( _mm_and_si128( a, b ), _mm_and_si128( c, d ) ) );
+        }
+        for( ; i + 16 <= n; i += 16 )
+            acc = _mm_and_si128( acc, _mm_loadu_si128( (const __m128i*)( data + i ) ) );
+
+        const __m128i m  = _mm_set1_epi32( (int)mask );
+        const bool    ok = _mm_movemask_epi8( _mm_cmpeq_epi32( _mm_and_si128( acc, m ), m ) ) == 0xFFFF;
+        return ok && BlockScalar( data + i, n - i, mask );
+    }
+
+    OMT_ROWCOPY_TARGET( "avx2" )
+    static bool BlockAVX2( const uint8_t* data, size_t n, uint32_t mask )
+    {
+        __m256i acc = _mm256_set1_epi32( -1 );
+        size_t  i   = 0;
+        for( ; i + 128 <= n; i += 128 )
+        {
+            const __m256i a = _mm256_loadu_si256( (const __m256i*)( data + i ) );
+            const __m256i b = _mm256_loadu_si256( (const __m256i*)( data + i + 32 ) );
+            const __m256i c = _mm256_loadu_si256( (const __m256i*)( data + i + 64 ) );
+            const __m256i d = _mm256_loadu_si256( (const __m256i*)( data + i + 96 ) );
+            acc = _mm256_and_si256( acc, _mm256_and_si256( _mm256_and_si256( a, b ), _mm256_and_si256( c, d ) ) );
+        }
+        for( ; i + 32 <= n; i += 32 )
+            acc = _mm256_and_si256( acc, _mm256_loadu_si256( (const __m256i*)( data + i ) ) );
+
+        const __m256i m  = _mm256_set1_epi32( (int)mask );
+        const bool    ok = (uint32_t)_mm256_movemask_epi8( _mm256_cmpeq_epi32( _mm256_and_si256( acc, m ), m ) ) == 0xFFFFFFFFu;
+        return ok && BlockScalar( data + i, n - i, mask );
+    }
+#endif
+
+#if defined( OMT_ROWCOPY_NEON )
+    static bool BlockNEON( const uint8_t* data, size_t n, uint32_t mask )
+    {
+        uint32x4_t acc = vdupq_n_u32( 0xFFFFFFFFu );
+        size_t     i   = 0;
+        for( ; i + 64 <= n; i += 64 )
+        {
+            const uint32x4_t a = vreinterpretq_u32_u8( vld1q_u8( data + i ) );
+            const uint32x4_t b = vreinterpretq_u32_u8( vld1q_u8( data + i + 16 ) );
+            const uint32x4_t c = vreinterpretq_u32_u8( vld1q_u8( data + i + 32 ) );
+            const uint32x4_t d = vreinterpretq_u32_u8( vld1q_u8( data + i + 48 ) );
+            acc = vandq_u32( acc, vandq_u32( vandq_u32( a, b ), vandq_u32( c, d ) ) );
+        }
+        for( ; i + 16 <= n; i += 16 )
+            acc = vandq_u32( acc, vreinterpretq_u32_u8( vld1q_u8( data + i ) ) );
+
+        const uint32x4_t m  = vdupq_n_u32( mask );
+        const bool       ok = vminvq_u32( vceqq_u32( vandq_u32( acc, m ), m ) ) == 0xFFFFFFFFu;
+        return ok && BlockScalar( data + i, n - i, mask );
+    }
+#endif
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+#include "OMTRowCopy.h"   // ISA detection and target attributes
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ---------------------------------------------------------------------------
+// OMTFrameHash
+//
+// 64-bit content hash of a frame, used to spot repeats of the previous frame
+// (a paused clip, a still) so they needn't be encoded and sent again.
+//
+// Not cryptographic and not stable across machines - it only has to tell
+// two frames from the same process apart.  The core is the XXH3-style
+// accumulate step: each of eight 64-bit lanes adds the 32x32->64 product of
+// the halves of its input word, mixed with a key that depends on the lane
+// and on the stripe's position in its block of kBlockStripes, and the
+// neighbouring lane (j ^ 1) adds the word itself.  After every block the
+// lanes are scrambled (xorshift, key, multiply), which makes the hash
+// depend on where each block sits - so moving content around the
+// frame changes it, not just changing the pixel values.  Lanes are folded
+// and avalanched at the end.  Every kernel computes the same function, so
+// results don't depend on the ISA the CPU reports.
+// ---------------------------------------------------------------------------
+
+class OMTFrameHash
+{
+public:
+    static uint64_t Hash( const uint8_t* data, size_t bytes, uint64_t seed = 0 )
+    {
+        uint32_t unused;
+        return Run< false >( data, bytes, seed, bytes, unused );
+    }
+
+    // Hash() plus, from the same pass over memory, the AND of every
+    // little-endian 32-bit word from byte `andFrom` (a multiple of 4) on;
+    // a trailing partial word's missing bytes count as 0xFF.  Lets a caller
+    // that also needs an alpha scan (OMTAlphaScan) avoid reading the frame
+    // a second time.
+    static uint64_t Hash( const uint8_t* data, size_t bytes, uint64_t seed,
+                          size_t andFrom, uint32_t& andWords )
+    {
+        return Run< true >( data, bytes, seed, andFrom, andWords );
+    }
+
+private:
+    static constexpr size_t   kLanes        = 8;
+    static constexpr size_t   kStripeBytes  = kLanes * 8;
+    static constexpr size_t   kBlockStripes = 16;   // stripes between scrambles
+    static constexpr uint64_t kPrime1       = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t kPrime2       = 0xC2B2AE3D27D4EB4Full;
+    static constexpr uint64_t kPrime32      = 0x9E3779B1ull;
+
+    static uint64_t Key( size_t lane ) { return kPrime1 * ( 2 * lane + 1 ); }
+
+    // Mixed into every lane's key for the stripe at `pos` in its block
+    static uint64_t Salt( size_t pos ) { return kPrime2 * ( pos + 1 ); }
+
+    // Scramble a lane at the end of a block.  The multiply is by a 32-bit
+    // prime so vector units can do it with two 32x32->64 products.
+    static uint64_t Scramble( uint64_t a, size_t lane )
+    {
+        return ( a ^ ( a >> 47 ) ^ Key( lane ) ) * kPrime32;
+    }
+
+    // splitmix64 finaliser
+    static uint64_t Mix( uint64_t x )
+    {
+        x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27; x *= 0x94D049BB133111EBull;
+        return x ^ ( x >> 31 );
+    }
+
+    template< bool kAnd >
+    static uint64_t Run( const uint8_t* data, size_t bytes, uint64_t seed,
+                         size_t andFrom, uint32_t& andWords )
+    {
+        uint64_t acc[ kLanes ];
+        for( size_t j = 0; j < kLanes; ++j )
+            acc[ j ] = Key( j ) ^ seed;
+
+        // Stripes before `split` are only hashed; the words between andFrom
+        // and there are ANDed on their own
+        const size_t stripes = bytes / kStripeBytes;
+        const size_t split   = kAnd ? std::min( ( andFrom + kStripeBytes - 1 ) / kStripeBytes, stripes ) : stripes;
+        uint64_t all = ~0ull;
+        Accumulate< false >( acc, data, split, 0, all );
+        Accumulate< kAnd >( acc, data + split * kStripeBytes, stripes - split, split, all );
+
+        // Tail shorter than a stripe: zero-pad it into one more
+        const size_t done = stripes * kStripeBytes;
+        if( done < bytes )
+        {
+            uint8_t last[ kStripeBytes ] = {};
+            std::memcpy( last, data + done, bytes - done );
+            uint64_t unused;
+            AccumulateScalar< false >( acc, last, 1, stripes, unused );
+        }
+
+        if( kAnd )
+        {
+            uint32_t words = uint32_t( all ) & uint32_t( all >> 32 );
+            if( andFrom < split * kStripeBytes )
+                words &= AndWords( data + andFrom, split * kStripeBytes - andFrom );
+            if( done < bytes )
+                words &= AndWords( data + std::max( done, andFrom ), bytes - std::max( done, andFrom ) );
+            andWords = words;
+        }
+
+        uint64_t h = (uint64_t)bytes * kPrime1;
+        for( size_t j = 0; j < kLanes; ++j )
+            h = ( h ^ Mix( acc[ j ] ) ) * kPrime2;
+        return Mix( h );
+    }
+
+    template< bool kAnd >
+    static void Accumulate( uint64_t* acc, const uint8_t* data, size_t stripes, size_t first, uint64_t& all )
+    {
+        if( !stripes )
+            return;
+        switch( OMTRowCopy::BestIsa() )
+        {
+#if defined( OMT_ROWCOPY_X86 )
+        case OMTRowCopy::Isa::AVX512:
+        case OMTRowCopy::Isa::AVX2: AccumulateAVX2< kAnd >( acc, data, stripes, first, all ); break;
+        case OMTRowCopy::Isa::SSE2: AccumulateSSE2< kAnd >( acc, data, stripes, first, all ); break;
+#endif
+        default:                    AccumulateScalar< kAnd >( acc, data, stripes, first, all ); break;
+        }
+    }
+
+    // AND of the 32-bit words of a short run, missing bytes of a trailing
+    // partial word as 0xFF
+    static uint32_t AndWords( const uint8_t* data, size_t n )
+    {
+        uint32_t words = ~0u;
+        for( size_t i = 0; i < n; i += 4 )
+        {
+            uint32_t w = ~0u;
+            std::memcpy( &w, data + i, std::min< size_t >( 4, n - i ) );
+            words &= w;
+        }
+        return words;
+    }
+
+    // `first` = index of the first stripe in the whole input.  With kAnd,
+    // every input word is also ANDed into `all`.
+    template< bool kAnd >
+    static void AccumulateScalar( uint64_t* acc, const uint8_t* data, size_t stripes, size_t first, uint64_t& all )
+    {
+        for( size_t s = first; s < first + stripes; ++s, data += kStripeBytes )
+        {
+            const uint64_t salt = Salt( s % kBlockStripes );
+            for( size_t j = 0; j < kLanes; ++j )
+            {
+                uint64_t w;
+                std::memcpy( &w, data + j * 8, 8 );
+                const uint64_t k = w ^ Key( j ) ^ salt;
+                acc[ j ^ 1 ] += w;                  // neighbouring lane, as XXH3
+                acc[ j ]     += ( k & 0xFFFFFFFFull ) * ( k >> 32 );
+                if( kAnd )
+                    all &= w;
+            }
+            if( s % kBlockStripes == kBlockStripes - 1 )
+                for( size_t j = 0; j < kLanes; ++j )
+                    acc[ j ] = Scramble( acc[ j ], j );
+        }
+    }
+
+#if defined( OMT_ROWCOPY_X86 )
+    template< bool kAnd >
+    static void AccumulateSSE2( uint64_t* acc, const uint8_t* data, size_t stripes, size_t first, uint64_t& all )
+    {
+        __m128i a[ 4 ], key[ 4 ];
+        __m128i both = _mm_set1_epi32( -1 );
+        for( int j = 0; j < 4; ++j )
+        {
+            a[ j ]   = _mm_loadu_si128( (const __m128i*)( acc + 2 * j ) );
+            key[ j ] = _mm_set_epi64x( (long long)Key( 2 * j + 1 ), (long long)Key( 2 * j ) );
+        }
+        const __m128i prime = _mm_set1_epi64x( (long long)kPrime32 );
+        for( size_t s = first; s < first + stripes; ++s, data += kStripeBytes )
+        {
+            const __m128i salt = _mm_set1_epi64x( (long long)Salt( s % kBlockStripes ) );
+            for( int j = 0; j < 4; ++j )
+            {
+                const __m128i w = _mm_loadu_si128( (const __m128i*)( data + 16 * j ) );
+                const __m128i k = _mm_xor_si128( w, _mm_xor_si128( key[ j ], salt ) );
+                const __m128i x = _mm_shuffle_epi32( w, _MM_SHUFFLE( 1, 0, 3, 2 ) );   // lanes swapped
+                a[ j ] = _mm_add_epi64( a[ j ], _mm_add_epi64( x, _mm_mul_epu32( k, _mm_srli_epi64( k, 32 ) ) ) );
+                if( kAnd )
+                    both = _mm_and_si128( both, w );
+            }
+            if( s % kBlockStripes == kBlockStripes - 1 )
+            {
+                // Scramble(): 64x32 multiply as lo * p + ( hi * p ) << 32
+                for( int j = 0; j < 4; ++j )
+                {
+                    const __m128i x = _mm_xor_si128( _mm_xor_si128( a[ j ], _mm_srli_epi64( a[ j ], 47 ) ), key[ j ] );
+                    a[ j ] = _mm_add_epi64( _mm_mul_epu32( x, prime ),
+                                            _mm_slli_epi64( _mm_mul_epu32( _mm_srli_epi64( x, 32 ), prime ), 32 ) );
+                }
+            }
+        }
+        for( int j = 0; j < 4; ++j )
+            _mm_storeu_si128( (__m128i*)( acc + 2 * j ), a[ j ] );
+        if( kAnd )
+        {
+            uint64_t lanes[ 2 ];
+            _mm_storeu_si128( (__m128i*)lanes, both );
+            all &= lanes[ 0 ] & lanes[ 1 ];
+        }
+    }
+
+    template< bool kAnd >
+    OMT_ROWCOPY_TARGET( "avx2" )
+    static void AccumulateAVX2( uint64_t* acc, const uint8_t* data, size_t stripes, size_t first, uint64_t& all )
+    {
+        __m256i a[ 2 ], key[ 2 ];
+        __m256i both = _mm256_set1_epi32( -1 );
+        for( int j = 0; j < 2; ++j )
+        {
+            a[ j ]   = _mm256_loadu_si256( (const __m256i*)( acc + 4 * j ) );
+            key[ j ] = _mm256_set_epi64x( (long long)Key( 4 * j + 3 ), (long long)Key( 4 * j + 2 ),
+                                          (long long)Key( 4 * j + 1 ), (long long)Key( 4 * j ) );
+        }
+        const __m256i prime = _mm256_set1_epi64x( (long long)kPrime32 );
+        for( size_t s = first; s < first + stripes; ++s, data += kStripeBytes )
+        {
+            const __m256i salt = _mm256_set1_epi64x( (long long)Salt( s % kBlockStripes ) );
+            for( int j = 0; j < 2; ++j )
+            {
+                const __m256i w = _mm256_loadu_si256( (const __m256i*)( data + 32 * j ) );
+                const __m256i k = _mm256_xor_si256( w, _mm256_xor_si256( key[ j ], salt ) );
+                const __m256i x = _mm256_shuffle_epi32( w, _MM_SHUFFLE( 1, 0, 3, 2 ) );   // lanes swapped
+                a[ j ] = _mm256_add_epi64( a[ j ], _mm256_add_epi64( x, _mm256_mul_epu32( k, _mm256_srli_epi64( k, 32 ) ) ) );
+                if( kAnd )
+                    both = _mm256_and_si256( both, w );
+            }
+            if( s % kBlockStripes == kBlockStripes - 1 )
+            {
+                // Scramble(): 64x32 multiply as lo * p + ( hi * p ) << 32
+                for( int j = 0; j < 2; ++j )
+                {
+                    const __m256i x = _mm256_xor_si256( _mm256_xor_si256( a[ j ], _mm256_srli_epi64( a[ j ], 47 ) ), key[ j ] );
+                    a[ j ] = _mm256_add_epi64( _mm256_mul_epu32( x, prime ),
+                                               _mm256_slli_epi64( _mm256_mul_epu32( _mm256_srli_epi64( x, 32 ), prime ), 32 ) );
+                }
+            }
+        }
+        for( int j = 0; j < 2; ++j )
+            _mm256_storeu_si256( (__m256i*)( acc + 4 * j ), a[ j ] );
+        if( kAnd )
+        {
+            uint64_t lanes[ 4 ];
+            _mm256_storeu_si256( (__m256i*)lanes, both );
+            all &= lanes[ 0 ] & lanes[ 1 ] & lanes[ 2 ] & lanes[ 3 ];
+        }
+    }
+#endif
+};
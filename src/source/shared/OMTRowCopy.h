@@ -0,0 +1,418 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined( _M_X64 ) || defined( __x86_64__ ) || defined( _M_IX86 ) || defined( __i386__ )
+    #define OMT_ROWCOPY_X86 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#elif defined( _M_ARM64 ) || defined( __aarch64__ )
+    #define OMT_ROWCOPY_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// GCC/Clang only emit wider-ISA intrinsics inside functions tagged for that
+// ISA; MSVC allows them anywhere, so the tag is a no-op there.
+#if defined( OMT_ROWCOPY_X86 ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+    #define OMT_ROWCOPY_TARGET( isa ) __attribute__( ( target( isa ) ) )
+#else
+    #define OMT_ROWCOPY_TARGET( isa )
+#endif
+
+// ---------------------------------------------------------------------------
+// OMTRowCopy
+//
+// Frame copy kernels for the readback -> send hand-off: straight copies,
+// row flips (negative source stride) and crop / stride repacking, all as
+// one "copy `rows` rows of `rowBytes`" primitive.
+//
+// Frames up to kStreamThreshold just use memcpy per row - the CRT's is
+// already vectorised, and the send thread reads every frame straight back
+// (alpha scan, hash, encode), which is cheaper from cache.  Only frames
+// too big to stay cached anyway (8K) are copied with non-temporal stores,
+// using the widest ISA the CPU reports at runtime (AVX-512, AVX2, SSE2;
+// plain wide loads/stores on NEON), so they don't evict everything else
+// on their way through.  Copy plus re-read, measured with RowCopyBench:
+// streaming costs up to 40% more while the frame would still fit in the
+// cache, and breaks even or wins once it can't.  Frames over
+// kParallelThreshold are also split into row bands across a small
+// process-wide worker pool.
+//
+// The pool's workers start on the first parallel copy and are stopped when
+// the last plugin instance calls Release(), on a host thread - never from a
+// static destructor, which on Windows runs under the loader lock, where
+// joining a thread deadlocks.  Without an Acquire() copies run on the
+// calling thread only.
+// ---------------------------------------------------------------------------
+
+class OMTRowCopy
+{
+public:
+    static constexpr size_t kStreamThreshold   = 64u << 20;   // bytes
+    static constexpr size_t kParallelThreshold = 16u << 20;   // bytes
+
+    enum class Isa { Scalar, SSE2, AVX2, AVX512, NEON };
+
+    // Copies `rows` rows of `rowBytes` bytes.  Row i is read from
+    // src + i * srcStride, so pass a pointer to the last row and a negative
+    // stride to flip vertically.
+    static void Rows( uint8_t* dst, size_t dstStride,
+                      const uint8_t* src, ptrdiff_t srcStride,
+                      size_t rowBytes, size_t rows )
+    {
+        const size_t total  = rowBytes * rows;
+        const bool   stream = total >= kStreamThreshold;
+        if( total >= kParallelThreshold && rows >= 2 * kMinBandRows )
+            Pool::Instance().Run( dst, dstStride, src, srcStride, rowBytes, rows, stream );
+        else
+            Band( dst, dstStride, src, srcStride, rowBytes, rows, stream );
+    }
+
+    // Contiguous copy of `bytes` bytes, routed through the same kernels.
+    static void Bytes( uint8_t* dst, const uint8_t* src, size_t bytes )
+    {
+        const size_t rows = bytes / kChunkBytes;
+        const size_t tail = bytes - rows * kChunkBytes;
+        if( rows )
+            Rows( dst, kChunkBytes, src, (ptrdiff_t)kChunkBytes, kChunkBytes, rows );
+        if( tail )
+            std::memcpy( dst + rows * kChunkBytes, src + rows * kChunkBytes, tail );
+    }
+
+    // Balanced calls from each plugin instance's constructor / destructor.
+    // The last Release() stops the pool's workers.
+    static void Acquire() { Pool::Instance().Acquire(); }
+    static void Release() { Pool::Instance().Release(); }
+
+    // The kernel the streaming path dispatches to on this CPU.
+    static Isa BestIsa()
+    {
+        static const Isa isa = DetectIsa();
+        return isa;
+    }
+
+    // True if this CPU can run `isa`'s kernel.
+    static bool Supported( Isa isa )
+    {
+#if defined( OMT_ROWCOPY_X86 )
+        return isa != Isa::NEON && isa <= BestIsa();
+#elif defined( OMT_ROWCOPY_NEON )
+        return isa == Isa::Scalar || isa == Isa::NEON;
+#else
+        return isa == Isa::Scalar;
+#endif
+    }
+
+    // The single-row kernel for a Supported() `isa` (memcpy for Scalar).
+    // Rows() picks one itself; this is for checking each of them.
+    using RowFn = void ( * )( uint8_t* dst, const uint8_t* src, size_t n );
+    static RowFn Kernel( Isa isa )
+    {
+        switch( isa )
+        {
+#if defined( OMT_ROWCOPY_X86 )
+        case Isa::AVX512: return &RowAVX512;
+        case Isa::AVX2:   return &RowAVX2;
+        case Isa::SSE2:   return &RowSSE2;
+#elif defined( OMT_ROWCOPY_NEON )
+        case Isa::NEON:   return &RowNEON;
+#endif
+        default:          return &RowMemcpy;
+        }
+    }
+
+private:
+    static constexpr size_t kChunkBytes  = 64u << 10;  // Bytes() row size
+    static constexpr size_t kMinBandRows = 16;
+
+    // -----------------------------------------------------------------------
+    // Per-band driver: picks memcpy or the streaming kernel for every row
+    // -----------------------------------------------------------------------
+    static void Band( uint8_t* dst, size_t dstStride,
+                      const uint8_t* src, ptrdiff_t srcStride,
+                      size_t rowBytes, size_t rows, bool stream )
+    {
+        const RowFn copyRow = stream ? Kernel( BestIsa() ) : &RowMemcpy;
+
+        for( size_t i = 0; i < rows; ++i )
+            copyRow( dst + i * dstStride, src + (ptrdiff_t)i * srcStride, rowBytes );
+
+#if defined( OMT_ROWCOPY_X86 )
+        if( stream )
+            _mm_sfence();   // make the non-temporal stores visible to the send thread
+#endif
+    }
+
+    static void RowMemcpy( uint8_t* dst, const uint8_t* src, size_t n )
+    {
+        std::memcpy( dst, src, n );
+    }
+
+    // Copies the unaligned head with memcpy so the vector body can use
+    // aligned streaming stores; returns the bytes consumed.
+    static size_t AlignHead( uint8_t* dst, const uint8_t* src, size_t n, size_t align )
+    {
+        const size_t head = std::min( n, ( align - ( (uintptr_t)dst & ( align - 1 ) ) ) & ( align - 1 ) );
+        std::memcpy( dst, src, head );
+        return head;
+    }
+
+#if defined( OMT_ROWCOPY_X86 )
+    static void RowSSE2( uint8_t* dst, const uint8_t* src, size_t n )
+    {
+        size_t i = AlignHead( dst, src, n, 16 );
+        for( ; i + 64 <= n; i += 64 )
+        {
+            const __m128i a = _mm_loadu_si128( (const __m128i*)( src + i ) );
+            const __m128i b = _mm_loadu_si128( (const __m128i*)( src + i + 16 ) );
+            const __m128i c = _mm_loadu_si128( (const __m128i*)( src + i + 32 ) );
+            const __m128i d = _mm_loadu_si128( (const __m128i*)( src + i + 48 ) );
+            _mm_stream_si128( (__m128i*)( dst + i ),      a );
+            _mm_stream_si128( (__m128i*)( dst + i + 16 ), b );
+            _mm_stream_si128( (__m128i*)( dst + i + 32 ), c );
+            _mm_stream_si128( (__m128i*)( dst + i + 48 ), d );
+        }
+        for( ; i + 16 <= n; i += 16 )
+            _mm_stream_si128( (__m128i*)( dst + i ), _mm_loadu_si128( (const __m128i*)( src + i ) ) );
+        std::memcpy( dst + i, src + i, n - i );
+    }
+
+    OMT_ROWCOPY_TARGET( "avx2" )
+    static void RowAVX2( uint8_t* dst, const uint8_t* src, size_t n )
+    {
+        size_t i = AlignHead( dst, src, n, 32 );
+        for( ; i + 128 <= n; i += 128 )
+        {
+            const __m256i a = _mm256_loadu_si256( (const __m256i*)( src + i ) );
+            const __m256i b = _mm256_loadu_si256( (const __m256i*)( src + i + 32 ) );
+            const __m256i c = _mm256_loadu_si256( (const __m256i*)( src + i + 64 ) );
+            const __m256i d = _mm256_loadu_si256( (const __m256i*)( src + i + 96 ) );
+            _mm256_stream_si256( (__m256i*)( dst + i ),      a );
+            _mm256_stream_si256( (__m256i*)( dst + i + 32 ), b );
+            _mm256_stream_si256( (__m256i*)( dst + i + 64 ), c );
+            _mm256_stream_si256( (__m256i*)( dst + i + 96 ), d );
+        }
+        for( ; i + 32 <= n; i += 32 )
+            _mm256_stream_si256( (__m256i*)( dst + i ), _mm256_loadu_si256( (const __m256i*)( src + i ) ) );
+        std::memcpy( dst + i, src + i, n - i );
+    }
+
+    OMT_ROWCOPY_TARGET( "avx512f" )
+    static void RowAVX512( uint8_t* dst, const uint8_t* src, size_t n )
+    {
+        size_t i = AlignHead( dst, src, n, 64 );
+        for( ; i + 256 <= n; i += 256 )
+        {
+            const __m512i a = _mm512_loadu_si512( (const void*)( src + i ) );
+            const __m512i b = _mm512_loadu_si512( (const void*)( src + i + 64 ) );
+            const __m512i c = _mm512_loadu_si512( (const void*)( src + i + 128 ) );
+            const __m512i d = _mm512_loadu_si512( (const void*)( src + i + 192 ) );
+            _mm512_stream_si512( (__m512i*)( dst + i ),       a );
+            _mm512_stream_si512( (__m512i*)( dst + i + 64 ),  b );
+            _mm512_stream_si512( (__m512i*)( dst + i + 128 ), c );
+            _mm512_stream_si512( (__m512i*)( dst + i + 192 ), d );
+        }
+        for( ; i + 64 <= n; i += 64 )
+            _mm512_stream_si512( (__m512i*)( dst + i ), _mm512_loadu_si512( (const void*)( src + i ) ) );
+        std::memcpy( dst + i, src + i, n - i );
+    }
+#endif
+
+#if defined( OMT_ROWCOPY_NEON )
+    // No portable non-temporal store intrinsic on ARM; wide unrolled copies
+    // still beat byte-granular CRT paths on some platforms.
+    static void RowNEON( uint8_t* dst, const uint8_t* src, size_t n )
+    {
+        size_t i = 0;
+        for( ; i + 64 <= n; i += 64 )
+        {
+            const uint8x16_t a = vld1q_u8( src + i );
+            const uint8x16_t b = vld1q_u8( src + i + 16 );
+            const uint8x16_t c = vld1q_u8( src + i + 32 );
+            const uint8x16_t d = vld1q_u8( src + i + 48 );
+            vst1q_u8( dst + i,      a );
+            vst1q_u8( dst + i + 16, b );
+            vst1q_u8( dst + i + 32, c );
+            vst1q_u8( dst + i + 48, d );
+        }
+        std::memcpy( dst + i, src + i, n - i );
+    }
+#endif
+
+    static Isa DetectIsa()
+    {
+#if defined( OMT_ROWCOPY_X86 )
+    #ifdef _MSC_VER
+        int info[ 4 ] = {};
+        __cpuid( info, 1 );
+        const bool osxsave = ( info[ 2 ] & ( 1 << 27 ) ) != 0;
+        const bool avx     = ( info[ 2 ] & ( 1 << 28 ) ) != 0;
+        const unsigned long long xcr0 = osxsave ? _xgetbv( 0 ) : 0;
+        __cpuidex( info, 7, 0 );
+        const bool avx2    = avx && ( xcr0 & 0x6 ) == 0x6 && ( info[ 1 ] & ( 1 << 5 ) );
+        const bool avx512  = avx2 && ( xcr0 & 0xE6 ) == 0xE6 && ( info[ 1 ] & ( 1 << 16 ) );
+    #else
+        __builtin_cpu_init();
+        const bool avx2    = __builtin_cpu_supports( "avx2" );
+        const bool avx512  = __builtin_cpu_supports( "avx512f" );
+    #endif
+        if( avx512 ) return Isa::AVX512;
+        if( avx2 )   return Isa::AVX2;
+        return Isa::SSE2;   // baseline on x86-64
+#elif defined( OMT_ROWCOPY_NEON )
+        return Isa::NEON;   // baseline on AArch64
+#else
+        return Isa::Scalar;
+#endif
+    }
+
+    // -----------------------------------------------------------------------
+    // Pool — splits one large copy into row bands across a few workers.
+    // The calling thread always takes a band itself, so a copy never waits
+    // on a worker that hasn't been scheduled yet any longer than its band.
+    // -----------------------------------------------------------------------
+    class Pool
+    {
+    public:
+        static Pool& Instance()
+        {
+            static Pool inst;
+            return inst;
+        }
+
+        void Acquire()
+        {
+            std::lock_guard< std::mutex > runLock( mRunMutex );
+            ++mUsers;
+        }
+
+        void Release()
+        {
+            std::lock_guard< std::mutex > runLock( mRunMutex );
+            if( mUsers == 0 || --mUsers > 0 )
+                return;
+            Stop();
+        }
+
+        void Run( uint8_t* dst, size_t dstStride, const uint8_t* src, ptrdiff_t srcStride,
+                  size_t rowBytes, size_t rows, bool stream )
+        {
+            // Several plugin instances may copy at once; one job at a time.
+            std::lock_guard< std::mutex > runLock( mRunMutex );
+            if( mWorkers.empty() && mUsers > 0 )
+                Start();
+
+            const size_t parts = std::min( mWorkers.size() + 1, rows / kMinBandRows );
+            const size_t band  = ( rows + parts - 1 ) / parts;
+
+            {
+                std::lock_guard< std::mutex > lock( mMutex );
+                mJob       = { dst, dstStride, src, srcStride, rowBytes, rows, band, stream };
+                mNextBand  = 1;   // band 0 is ours
+                mBandCount = parts;
+                mPending   = parts - 1;
+                ++mGeneration;
+            }
+            mWake.notify_all();
+
+            Band( dst, dstStride, src, srcStride, rowBytes, std::min( band, rows ), stream );
+
+            std::unique_lock< std::mutex > lock( mMutex );
+            mDone.wait( lock, [ this ] { return mPending == 0; } );
+        }
+
+    private:
+        struct Job
+        {
+            uint8_t*       dst;
+            size_t         dstStride;
+            const uint8_t* src;
+            ptrdiff_t      srcStride;
+            size_t         rowBytes, rows, band;
+            bool           stream;
+        };
+
+        Pool() = default;
+
+        // Runs at DLL unload, under the loader lock: workers a host never
+        // released are let go rather than joined.
+        ~Pool()
+        {
+            for( auto& t : mWorkers )
+                if( t.joinable() ) t.detach();
+        }
+
+        // Both with mRunMutex held
+        void Start()
+        {
+            const unsigned cores = std::max( 1u, std::thread::hardware_concurrency() );
+            const unsigned count = std::min( 3u, cores > 2 ? cores / 2 : 0u );
+            mRunning = true;
+            for( unsigned i = 0; i < count; ++i )
+                mWorkers.emplace_back( &Pool::WorkerFunc, this );
+        }
+
+        void Stop()
+        {
+            {
+                std::lock_guard< std::mutex > lock( mMutex );
+                mRunning = false;
+            }
+            mWake.notify_all();
+            for( auto& t : mWorkers )
+                if( t.joinable() ) t.join();
+            mWorkers.clear();
+        }
+
+        void WorkerFunc()
+        {
+            uint64_t seen = 0;
+            std::unique_lock< std::mutex > lock( mMutex );
+            for( ;; )
+            {
+                mWake.wait( lock, [ & ] { return !mRunning || mGeneration != seen; } );
+                if( !mRunning )
+                    return;
+                seen = mGeneration;
+
+                while( mNextBand < mBandCount )
+                {
+                    const size_t b     = mNextBand++;
+                    const Job    job   = mJob;
+                    const size_t first = b * job.band;
+                    const size_t count = std::min( job.band, job.rows - std::min( first, job.rows ) );
+
+                    lock.unlock();
+                    if( count )
+                        Band( job.dst + first * job.dstStride, job.dstStride,
+                              job.src + (ptrdiff_t)first * job.srcStride, job.srcStride,
+                              job.rowBytes, count, job.stream );
+                    lock.lock();
+
+                    if( --mPending == 0 )
+                        mDone.notify_one();
+                }
+            }
+        }
+
+        std::vector<std::thread> mWorkers;
+        std::mutex               mRunMutex;   // also guards mWorkers and mUsers
+        size_t                   mUsers = 0;
+        std::mutex               mMutex;
+        std::condition_variable  mWake, mDone;
+        Job                      mJob = {};
+        size_t                   mNextBand = 0, mBandCount = 0, mPending = 0;
+        uint64_t                 mGeneration = 0;
+        bool                     mRunning = true;
+    };
+};
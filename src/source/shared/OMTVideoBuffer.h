@@ -1,83 +1,269 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
-#include <mutex>
+#include <functional>
 #include <vector>
 
+// ---------------------------------------------------------------------------
+// TripleBuffer<T>
+//
+// Lock-free single-producer / single-consumer mailbox.  Three slots rotate
+// between the writer (back), the reader (front) and a shared middle slot:
+//
+//   - The writer fills WriteSlot() at leisure, then Publish() atomically
+//     swaps it with the middle slot.  It never waits for the reader.
+//   - The reader calls TryRead(), which swaps the middle slot into the
+//     front position if something new was published.  The returned slot
+//     belongs to the reader until its next TryRead().
+//
+// Only the index exchange is shared, so neither side ever blocks the other.
+// Readers don't park here: they are told about new slots from outside
+// (see OMTFrameSignal).
+// ---------------------------------------------------------------------------
+
+template< typename T >
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    TripleBuffer( const TripleBuffer& ) = delete;
+    TripleBuffer& operator=( const TripleBuffer& ) = delete;
+
+    // Writer side: the slot to fill for the next Publish().
+    T& WriteSlot() { return mSlots[ mBack ]; }
+
+    // Writer side: hand WriteSlot() to the reader.
+    // Returns true if this replaced a published slot the reader never saw.
+    bool Publish()
+    {
+        const uint8_t prev = mMiddle.exchange( uint8_t( mBack | kFresh ) );
+        mBack = prev & kIndexMask;
+        return ( prev & kFresh ) != 0;
+    }
+
+    // Reader side: newest published slot, or nullptr if nothing new.
+    T* TryRead()
+    {
+        if( !( mMiddle.load( std::memory_order_acquire ) & kFresh ) )
+            return nullptr;
+
+        const uint8_t prev = mMiddle.exchange( mFront, std::memory_order_acq_rel );
+        mFront = prev & kIndexMask;
+        return &mSlots[ mFront ];
+    }
+
+    // Discards every slot's contents and any unread publish.  Only valid
+    // while neither side is running (e.g. after joining the reader thread).
+    template< typename Fn >
+    void Reset( Fn&& clearSlot )
+    {
+        for( T& slot : mSlots )
+            clearSlot( slot );
+        mMiddle.store( uint8_t( mMiddle.load() & kIndexMask ) );
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh     = 0x4;
+
+    T                    mSlots[ 3 ];
+    uint8_t              mBack  = 0;         // writer-owned
+    uint8_t              mFront = 1;         // reader-owned
+    std::atomic<uint8_t> mMiddle{ 2 };       // shared: slot index | kFresh
+};
+
+// ---------------------------------------------------------------------------
+// OMTFrameSignal
+//
+// Doorbell shared by several OMTVideoBuffers, so their reader hears about
+// whichever of them publishes next - e.g. a task on a thread pool, which
+// SetHandler()-s a callback that Notify() runs on the notifying thread.
+// ---------------------------------------------------------------------------
+
+class OMTFrameSignal
+{
+public:
+    // Writer side (any buffer), or to prod the reader without a frame.
+    void Notify()
+    {
+        if( mHandler )
+            mHandler();
+    }
+
+    // Set before any buffer notifies, e.g. before attaching it with SetSignal().
+    void SetHandler( std::function< void() > handler ) { mHandler = std::move( handler ); }
+
+private:
+    std::function< void() > mHandler;
+};
+
 // ---------------------------------------------------------------------------
 // OMTVideoBuffer
 //
-// A simple double-buffer that lets one thread write pixel data (the GL render
-// thread, via PBO readback) while another thread reads it (the OMT send
-// thread).  "Double buffer" means the writer never blocks waiting for the
-// reader – it just overwrites the back buffer and flips.
+// Hands pixel data from the writer (the GL render thread, via PBO readback)
+// to the reader (the OMT send thread) through a TripleBuffer, so the GL
+// thread never waits for a send in progress and vice versa.
+//
+// Each frame carries the OMT codec FourCC and colour space it was packed
+// with (BGRA by default, which both FFGL and OMT support natively).
+//
+// Frames are either copied into the slot's own `pixels`, or - zero-copy -
+// reference memory the writer keeps alive (a persistently mapped PBO) along
+// with a counter that is decremented once the reader or a newer publish is
+// done with it.  Readers should use Data()/DataBytes() to cover both.
 //
-// Layout of each buffer slot:
-//   [ width : uint32 ][ height : uint32 ][ stride : uint32 ]
-//   [ raw pixel bytes … ]
+// Writers may stamp a frame with when it was rendered, so the reader can
+// measure how long it took to get from the GL thread onto the wire.
 //
-// Format is always BGRA (4 bytes/pixel), which both FFGL and OMT support
-// natively and requires no conversion.
+// A reader serving several buffers attaches the same OMTFrameSignal to each
+// (SetSignal) and polls them with TryRead() whenever it fires.  There is no
+// blocking read: the send side is a task on SendExecutor's pool, and a
+// reader parked waiting for a frame would hold one of its workers.  The
+// signal's handler (SendExecutor::Notify) schedules the task instead.
 // ---------------------------------------------------------------------------
 
+struct OMTVideoFrame
+{
+    using Clock = std::chrono::steady_clock;
+
+    uint32_t             width  = 0;
+    uint32_t             height = 0;
+    uint32_t             stride = 0;
+    uint32_t             codec  = 0x41524742;  // OMTCodec_BGRA
+    uint32_t             colorSpace = 0;       // OMTColorSpace_Undefined
+    Clock::time_point    captured = {};        // render time, if the writer knows it
+    std::vector<uint8_t> pixels;
+
+    // Zero-copy frames only
+    const uint8_t*       external      = nullptr;
+    size_t               externalBytes = 0;
+    std::atomic<int>*    externalRefs  = nullptr;
+
+    const uint8_t* Data() const      { return external ? external : pixels.data(); }
+    size_t         DataBytes() const { return external ? externalBytes : pixels.size(); }
+
+    // Gives up the reference to writer-owned memory, if any
+    void ReleaseExternal()
+    {
+        if( externalRefs )
+            externalRefs->fetch_sub( 1, std::memory_order_release );
+        external      = nullptr;
+        externalBytes = 0;
+        externalRefs  = nullptr;
+    }
+};
+
 class OMTVideoBuffer
 {
 public:
     OMTVideoBuffer() = default;
 
-    // Call from the writer side (GL thread) to hand off a completed frame.
-    // Copies `dataBytes` bytes from `pixels` into the back buffer, then swaps.
+    // Call from the writer side (GL thread) to fill a frame in place.
+    // Returns the back slot's pixel storage, sized to `dataBytes`; write the
+    // frame into it, then call CommitWrite() to hand it to the reader.
+    // Slot storage is reused, so there are no allocations at a steady size.
+    uint8_t* BeginWrite( uint32_t width, uint32_t height, uint32_t stride,
+                         size_t dataBytes, OMTVideoFrame::Clock::time_point captured = {} )
+    {
+        OMTVideoFrame& frame = mFrames.WriteSlot();
+        frame.ReleaseExternal();
+        frame.width    = width;
+        frame.height   = height;
+        frame.stride   = stride;
+        frame.captured = captured;
+        frame.pixels.resize( dataBytes );
+        return frame.pixels.data();
+    }
+
+    // Publishes the frame filled since the last BeginWrite(), tagged with
+    // the OMT codec/colour space its bytes are laid out in.
+    void CommitWrite( uint32_t codec = 0x41524742, uint32_t colorSpace = 0 )
+    {
+        OMTVideoFrame& frame = mFrames.WriteSlot();
+        frame.codec      = codec;
+        frame.colorSpace = colorSpace;
+        Publish();
+    }
+
+    // Zero-copy hand-off: publishes a frame that points at `data` instead of
+    // copying it.  `data` must stay valid until *refs has been decremented,
+    // which happens once the reader has moved past the frame or it was
+    // replaced before the reader ever saw it.
+    void WriteExternal( uint32_t width, uint32_t height, uint32_t stride,
+                        uint32_t codec, uint32_t colorSpace,
+                        const uint8_t* data, size_t dataBytes, std::atomic<int>* refs,
+                        OMTVideoFrame::Clock::time_point captured = {} )
+    {
+        OMTVideoFrame& frame = mFrames.WriteSlot();
+        frame.ReleaseExternal();
+        frame.width         = width;
+        frame.height        = height;
+        frame.stride        = stride;
+        frame.codec         = codec;
+        frame.colorSpace    = colorSpace;
+        frame.captured      = captured;
+        frame.external      = data;
+        frame.externalBytes = dataBytes;
+        frame.externalRefs  = refs;
+        Publish();
+    }
+
+    // Convenience for writers that already have the frame in memory:
+    // copies `dataBytes` bytes from `pixels` into the back slot and publishes.
     void Write( uint32_t width, uint32_t height, uint32_t stride,
                 const uint8_t* pixels, size_t dataBytes )
     {
-        std::lock_guard< std::mutex > lock( mMutex );
-
-        auto& buf = mBuffers[ mBackIndex ];
-        buf.width  = width;
-        buf.height = height;
-        buf.stride = stride;
-        buf.pixels.resize( dataBytes );
-        std::memcpy( buf.pixels.data(), pixels, dataBytes );
-        buf.fresh = true;
-
-        // Flip back <-> front
-        mBackIndex  = 1 - mBackIndex;
+        std::memcpy( BeginWrite( width, height, stride, dataBytes ), pixels, dataBytes );
+        CommitWrite();
     }
 
-    // Call from the reader side (OMT send thread).
-    // Returns false if no new frame has arrived since the last call.
-    // Swaps the pixel buffer out rather than copying — O(1), no allocations.
-    bool Read( uint32_t& width, uint32_t& height, uint32_t& stride,
-               std::vector< uint8_t >& outPixels )
+    // Call from the reader side (OMT send thread): the newest unseen frame,
+    // or nullptr.  The frame stays valid (and untouched by the writer) until
+    // the next TryRead(); any zero-copy frame returned by the previous one is
+    // released first, either way.
+    const OMTVideoFrame* TryRead()
     {
-        std::lock_guard< std::mutex > lock( mMutex );
+        if( mReaderFrame )
+        {
+            mReaderFrame->ReleaseExternal();
+            mReaderFrame = nullptr;
+        }
 
-        int frontIndex = 1 - mBackIndex;
-        auto& buf = mBuffers[ frontIndex ];
+        OMTVideoFrame* frame = mFrames.TryRead();
+        if( !frame )
+            return nullptr;
+
+        mReaderFrame = frame;
+        return frame->DataBytes() ? frame : nullptr;
+    }
 
-        if( !buf.fresh || buf.pixels.empty() )
-            return false;
+    // Rings `signal` on every publish (nullptr = none).  Set it while no
+    // writer is running.
+    void SetSignal( OMTFrameSignal* signal ) { mSignal = signal; }
 
-        width      = buf.width;
-        height     = buf.height;
-        stride     = buf.stride;
-        outPixels.swap( buf.pixels );  // O(1) — outPixels' old buffer reused next Write
-        buf.fresh  = false;
-        return true;
+    // Drops every frame and releases all zero-copy references.  Only call
+    // while no reader thread is running.
+    void Reset()
+    {
+        mFrames.Reset( []( OMTVideoFrame& f ) { f.ReleaseExternal(); f.pixels.clear(); } );
+        mReaderFrame = nullptr;
     }
 
 private:
-    struct Slot
+    void Publish()
     {
-        uint32_t             width  = 0;
-        uint32_t             height = 0;
-        uint32_t             stride = 0;
-        std::vector<uint8_t> pixels;
-        bool                 fresh  = false;
-    };
-
-    std::mutex mMutex;
-    Slot       mBuffers[ 2 ];
-    int        mBackIndex = 0;   // the slot the writer writes into next
+        // A frame replaced before the reader saw it comes back as our next
+        // write slot; let go of its external memory now.
+        if( mFrames.Publish() )
+            mFrames.WriteSlot().ReleaseExternal();
+        if( mSignal )
+            mSignal->Notify();
+    }
+
+    TripleBuffer< OMTVideoFrame > mFrames;
+    OMTVideoFrame*                mReaderFrame = nullptr;   // reader-owned
+    OMTFrameSignal*               mSignal      = nullptr;
 };
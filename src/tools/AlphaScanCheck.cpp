@@ -0,0 +1,115 @@
+// Checks OMTAlphaScan: a single non-opaque alpha value must be found
+// wherever it sits - in a vector loop's body, in the scalar tail of a
+// block, in a trailing partial word, in the last row - and colour bytes
+// must never count as alpha.  A wrong "opaque" verdict would silently drop
+// the alpha channel on the wire.  Exits non-zero on failure.
+
+#include "OMTAlphaScan.h"
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static int sFailures = 0;
+
+static void Expect( bool ok, const char* what )
+{
+    std::printf( "%s  %s\n", ok ? "ok  " : "FAIL", what );
+    if( !ok )
+        ++sFailures;
+}
+
+static std::mt19937_64 sRng( 1 );
+
+// Opaque BGRA with random colour bytes
+static std::vector< uint8_t > OpaqueBGRA( size_t pixels )
+{
+    std::vector< uint8_t > v( pixels * 4 );
+    for( size_t i = 0; i < v.size(); ++i )
+        v[ i ] = ( i % 4 == 3 ) ? 0xFF : (uint8_t)sRng();
+    return v;
+}
+
+int main()
+{
+    // Every alpha position of every short frame: covers the tails after
+    // each vector width, and lengths that aren't a whole block
+    {
+        bool ok = true;
+        for( size_t pixels = 0; pixels <= 200 && ok; ++pixels )
+        {
+            std::vector< uint8_t > v = OpaqueBGRA( pixels );
+            ok = OMTAlphaScan::OpaqueBGRA( v.data(), v.size() );
+            for( size_t p = 0; p < pixels && ok; ++p )
+            {
+                v[ p * 4 + 3 ] = 0xFE;
+                ok = !OMTAlphaScan::OpaqueBGRA( v.data(), v.size() );
+                v[ p * 4 + 3 ] = 0xFF;
+            }
+        }
+        Expect( ok, "BGRA, every pixel of short frames" );
+    }
+
+    // Colour bytes of 0 next to opaque alpha are still opaque
+    {
+        std::vector< uint8_t > v( 4096 * 4 + 12, 0 );
+        for( size_t i = 3; i < v.size(); i += 4 )
+            v[ i ] = 0xFF;
+        Expect( OMTAlphaScan::OpaqueBGRA( v.data(), v.size() ), "BGRA, black is opaque" );
+    }
+
+    // A 1921 x 1081 frame - rows and blocks not a multiple of any vector
+    // width - with one translucent pixel at a time in a block's vector
+    // body, in a block's tail, and in the last row
+    {
+        const size_t w = 1921, h = 1081;
+        std::vector< uint8_t > v = OpaqueBGRA( w * h );
+        Expect( OMTAlphaScan::OpaqueBGRA( v.data(), v.size() ), "BGRA 1921x1081, opaque" );
+
+        const struct { size_t pixel; const char* what; } kCases[] = {
+            { 0,                   "BGRA 1921x1081, first pixel" },
+            { 1024 * 5 + 77,       "BGRA 1921x1081, vector body" },
+            { 1024 * 7 + 1023,     "BGRA 1921x1081, end of a block" },
+            { ( h - 1 ) * w + 5,   "BGRA 1921x1081, last row" },
+            { w * h - 1,           "BGRA 1921x1081, last pixel" },
+        };
+        for( const auto& c : kCases )
+        {
+            v[ c.pixel * 4 + 3 ] = 0x00;
+            Expect( !OMTAlphaScan::OpaqueBGRA( v.data(), v.size() ), c.what );
+            v[ c.pixel * 4 + 3 ] = 0xFF;
+        }
+    }
+
+    // Alpha planes (UYVA's, or PA16's) of odd length: every byte counts,
+    // including those of the trailing partial word
+    {
+        bool ok = true;
+        for( size_t bytes = 0; bytes <= 300 && ok; ++bytes )
+        {
+            std::vector< uint8_t > v( bytes, 0xFF );
+            ok = OMTAlphaScan::OpaquePlane( v.data(), v.size() );
+            for( size_t i = 0; i < bytes && ok; ++i )
+            {
+                v[ i ] = 0xFE;
+                ok = !OMTAlphaScan::OpaquePlane( v.data(), v.size() );
+                v[ i ] = 0xFF;
+            }
+        }
+        Expect( ok, "plane, every byte of short planes" );
+
+        const size_t w = 1921, h = 1081;
+        std::vector< uint8_t > v( w * h, 0xFF );
+        Expect( OMTAlphaScan::OpaquePlane( v.data(), v.size() ), "plane 1921x1081, opaque" );
+        for( size_t i : { (size_t)4096 * 3 + 100, ( h - 1 ) * w + 3, w * h - 1 } )
+        {
+            v[ i ] = 0x7F;
+            Expect( !OMTAlphaScan::OpaquePlane( v.data(), v.size() ),
+                    i == w * h - 1 ? "plane 1921x1081, last byte" :
+                    i > ( h - 1 ) * w ? "plane 1921x1081, last row" : "plane 1921x1081, vector body" );
+            v[ i ] = 0xFF;
+        }
+    }
+
+    return sFailures ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+// Checks OMTFrameHash: the SIMD kernel the CPU picks agrees with a plain
+// reference of the same function, and frames that differ only in where
+// their content sits hash differently.  Exits non-zero on failure.
+
+#include "OMTFrameHash.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static int sFailures = 0;
+
+static void Expect( bool ok, const char* what )
+{
+    std::printf( "%s  %s\n", ok ? "ok  " : "FAIL", what );
+    if( !ok )
+        ++sFailures;
+}
+
+// ---------------------------------------------------------------------------
+// Reference - the hash written out one stripe at a time, no SIMD
+// ---------------------------------------------------------------------------
+
+static uint64_t RefMix( uint64_t x )
+{
+    x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27; x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+static uint64_t RefHash( const uint8_t* data, size_t bytes, uint64_t seed )
+{
+    const uint64_t p1 = 0x9E3779B185EBCA87ull, p2 = 0xC2B2AE3D27D4EB4Full;
+    uint64_t acc[ 8 ];
+    for( size_t j = 0; j < 8; ++j )
+        acc[ j ] = p1 * ( 2 * j + 1 ) ^ seed;
+
+    const size_t stripes = ( bytes + 63 ) / 64;
+    for( size_t s = 0; s < stripes; ++s )
+    {
+        uint8_t stripe[ 64 ] = {};
+        std::memcpy( stripe, data + s * 64, std::min< size_t >( 64, bytes - s * 64 ) );
+        for( size_t j = 0; j < 8; ++j )
+        {
+            uint64_t w;
+            std::memcpy( &w, stripe + j * 8, 8 );
+            const uint64_t k = w ^ p1 * ( 2 * j + 1 ) ^ p2 * ( s % 16 + 1 );
+            acc[ j ^ 1 ] += w;
+            acc[ j ]     += ( k & 0xFFFFFFFFull ) * ( k >> 32 );
+        }
+        if( s % 16 == 15 )
+            for( size_t j = 0; j < 8; ++j )
+                acc[ j ] = ( acc[ j ] ^ ( acc[ j ] >> 47 ) ^ p1 * ( 2 * j + 1 ) ) * 0x9E3779B1ull;
+    }
+
+    uint64_t h = (uint64_t)bytes * p1;
+    for( size_t j = 0; j < 8; ++j )
+        h = ( h ^ RefMix( acc[ j ] ) ) * p2;
+    return RefMix( h );
+}
+
+static uint32_t RefAnd( const uint8_t* data, size_t bytes, size_t from )
+{
+    uint32_t words = ~0u;
+    for( size_t i = from; i < bytes; ++i )
+        words &= ~( uint32_t( uint8_t( ~data[ i ] ) ) << ( 8 * ( ( i - from ) & 3 ) ) );
+    return words;
+}
+
+// ---------------------------------------------------------------------------
+
+int main()
+{
+    std::mt19937_64 rng( 1 );
+    auto fill = [ & ]( std::vector< uint8_t >& v ) {
+        for( uint8_t& b : v )
+            b = (uint8_t)rng();
+    };
+
+    // Kernel vs reference, across lengths that end mid-stripe and mid-block
+    {
+        bool same = true;
+        for( size_t bytes : { 0, 1, 63, 64, 65, 1000, 1024, 1088, 4096 + 17, 1 << 20 } )
+        {
+            std::vector< uint8_t > v( bytes );
+            fill( v );
+            same = same && OMTFrameHash::Hash( v.data(), v.size(), 7 ) == RefHash( v.data(), v.size(), 7 );
+        }
+        Expect( same, "kernel matches reference" );
+    }
+
+    // The ANDing overload: same hash, and the AND of the words from any
+    // 4-byte boundary, with a single clear bit anywhere after it
+    {
+        bool same = true, ands = true;
+        for( size_t bytes : { 0, 3, 64, 130, 1000, 4096 + 18, 1 << 16 } )
+        {
+            for( size_t from = 0; from <= bytes; from += ( bytes < 256 ? 4 : 252 ) )
+            {
+                std::vector< uint8_t > v( bytes, 0xFF );
+                if( bytes )
+                {
+                    const size_t at = from + rng() % ( bytes - from + 1 );
+                    if( at < bytes )
+                        v[ at ] = (uint8_t)~( 1u << ( rng() % 8 ) );
+                    if( from )
+                        v[ rng() % from ] = 0;   // before `from`: not ANDed
+                }
+                uint32_t words = 0;
+                same = same && OMTFrameHash::Hash( v.data(), v.size(), 3, from, words ) ==
+                               OMTFrameHash::Hash( v.data(), v.size(), 3 );
+                ands = ands && words == RefAnd( v.data(), v.size(), from );
+            }
+        }
+        Expect( same, "ANDing hash matches plain hash" );
+        Expect( ands, "ANDing hash matches reference AND" );
+    }
+
+    // Swapping two 64-byte blocks
+    {
+        std::vector< uint8_t > a( 64 * 1024 );
+        fill( a );
+        std::vector< uint8_t > b = a;
+        std::swap_ranges( b.begin() + 64 * 3, b.begin() + 64 * 4, b.begin() + 64 * 900 );
+        Expect( OMTFrameHash::Hash( a.data(), a.size() ) != OMTFrameHash::Hash( b.data(), b.size() ),
+                "swapped 64-byte blocks" );
+    }
+
+    // Swapping two whole 16-stripe blocks (the scramble period)
+    {
+        std::vector< uint8_t > a( 64 * 1024 );
+        fill( a );
+        std::vector< uint8_t > b = a;
+        std::swap_ranges( b.begin(), b.begin() + 1024, b.begin() + 1024 * 10 );
+        Expect( OMTFrameHash::Hash( a.data(), a.size() ) != OMTFrameHash::Hash( b.data(), b.size() ),
+                "swapped 1 KB blocks" );
+    }
+
+    // A sprite on a flat 1080p BGRA frame, moved down 40 rows
+    {
+        const size_t w = 1920, h = 1080, stride = w * 4;
+        std::vector< uint8_t > sprite( 64 * 64 * 4 );
+        fill( sprite );
+        auto draw = [ & ]( size_t x, size_t y ) {
+            std::vector< uint8_t > frame( stride * h, 0x20 );
+            for( size_t r = 0; r < 64; ++r )
+                std::memcpy( &frame[ ( y + r ) * stride + x * 4 ], &sprite[ r * 64 * 4 ], 64 * 4 );
+            return frame;
+        };
+        const std::vector< uint8_t > a = draw( 512, 300 ), b = draw( 512, 340 );
+        Expect( OMTFrameHash::Hash( a.data(), a.size() ) != OMTFrameHash::Hash( b.data(), b.size() ),
+                "sprite moved 40 rows" );
+    }
+
+    return sFailures ? 1 : 0;
+}
@@ -0,0 +1,123 @@
+// Checks OMTRowCopy against plain memcpy: every row kernel this CPU can
+// run, at every alignment and with tails of every length; Rows() straight
+// and flipped, with odd row widths and padded strides, on the memcpy,
+// streaming and pool-parallel paths; and Bytes() either side of its 64 KB
+// chunking.  Exits non-zero on failure.
+
+#include "OMTRowCopy.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static int sFailures = 0;
+
+static void Expect( bool ok, const char* what )
+{
+    std::printf( "%s  %s\n", ok ? "ok  " : "FAIL", what );
+    if( !ok )
+        ++sFailures;
+}
+
+static std::mt19937_64 sRng( 1 );
+
+static std::vector< uint8_t > Random( size_t bytes )
+{
+    std::vector< uint8_t > v( bytes );
+    for( uint8_t& b : v )
+        b = (uint8_t)sRng();
+    return v;
+}
+
+// Every kernel, every dst / src alignment within a cache line, every
+// length up to a few vector bodies plus some longer ones.  Bytes either
+// side of the row must be left alone.
+static bool CheckKernel( OMTRowCopy::RowFn copyRow )
+{
+    const std::vector< uint8_t > src = Random( 4096 + 128 );
+    for( size_t dstOff = 0; dstOff < 64; ++dstOff )
+    {
+        for( size_t srcOff = 0; srcOff < 64; srcOff += 7 )
+        {
+            for( size_t n : { 0, 1, 15, 16, 17, 63, 64, 65, 127, 128, 129, 255, 256, 257, 300, 1023, 4000 } )
+            {
+                std::vector< uint8_t > dst( 4096 + 128, 0xEE ), want( dst );
+                std::memcpy( &want[ dstOff ], &src[ srcOff ], n );
+                copyRow( &dst[ dstOff ], &src[ srcOff ], n );
+#if defined( OMT_ROWCOPY_X86 )
+                _mm_sfence();
+#endif
+                if( dst != want )
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A frame of `rows` rows of `rowBytes`, copied into rows `dstStride` apart
+static bool CheckRows( size_t rowBytes, size_t rows, size_t dstStride, bool flip )
+{
+    const std::vector< uint8_t > src = Random( rowBytes * rows );
+    std::vector< uint8_t > dst( dstStride * rows, 0xEE ), want( dst );
+    for( size_t i = 0; i < rows; ++i )
+        std::memcpy( &want[ i * dstStride ], &src[ ( flip ? rows - 1 - i : i ) * rowBytes ], rowBytes );
+
+    const uint8_t*  from   = flip ? &src[ ( rows - 1 ) * rowBytes ] : src.data();
+    const ptrdiff_t stride = flip ? -(ptrdiff_t)rowBytes : (ptrdiff_t)rowBytes;
+    OMTRowCopy::Rows( dst.data(), dstStride, from, stride, rowBytes, rows );
+    return dst == want;
+}
+
+static bool CheckBytes( size_t bytes )
+{
+    const std::vector< uint8_t > src = Random( bytes );
+    std::vector< uint8_t > dst( bytes + 64, 0xEE ), want( dst );
+    std::copy( src.begin(), src.end(), want.begin() + 3 );
+    OMTRowCopy::Bytes( dst.data() + 3, src.data(), bytes );
+    return dst == want;
+}
+
+int main()
+{
+    OMTRowCopy::Acquire();   // lets the pool start its workers
+
+    static const struct { OMTRowCopy::Isa isa; const char* name; } kIsas[] = {
+        { OMTRowCopy::Isa::Scalar, "scalar kernel" }, { OMTRowCopy::Isa::SSE2,   "SSE2 kernel" },
+        { OMTRowCopy::Isa::AVX2,   "AVX2 kernel" },   { OMTRowCopy::Isa::AVX512, "AVX-512 kernel" },
+        { OMTRowCopy::Isa::NEON,   "NEON kernel" },
+    };
+    for( const auto& k : kIsas )
+        if( OMTRowCopy::Supported( k.isa ) )
+            Expect( CheckKernel( OMTRowCopy::Kernel( k.isa ) ), k.name );
+
+    // Under kStreamThreshold: memcpy per row, or the pool without streaming
+    for( bool flip : { false, true } )
+    {
+        bool ok = true;
+        for( size_t rowBytes : { 1, 3, 4 * 1921 + 3 } )
+            ok = ok && CheckRows( rowBytes, 37, rowBytes + 13, flip );
+        Expect( ok, flip ? "small frames, flipped" : "small frames" );
+
+        // 7683 x 1200 x 2 bytes, odd width: over kParallelThreshold
+        Expect( CheckRows( 7683 * 2, 1200, 7683 * 2 + 5, flip ),
+                flip ? "parallel, flipped" : "parallel" );
+    }
+
+    // Over kStreamThreshold as well: 8K BGRA plus an odd tail per row
+    const size_t bigRow = 7680 * 4 + 12, bigRows = ( OMTRowCopy::kStreamThreshold / bigRow ) + 31;
+    Expect( CheckRows( bigRow, bigRows, bigRow, false ), "streaming, parallel" );
+    Expect( CheckRows( bigRow, bigRows, bigRow + 64, true ), "streaming, parallel, flipped" );
+
+    {
+        bool ok = true;
+        for( size_t bytes : { 0, 1, 65535, 65536, 65537, 65536 * 3 + 1000, 17 * 1024 * 1024 + 77 } )
+            ok = ok && CheckBytes( bytes );
+        Expect( ok, "Bytes()" );
+    }
+
+    OMTRowCopy::Release();
+    return sFailures ? 1 : 0;
+}